@@ -0,0 +1,328 @@
+#include <array>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <iostream>
+#include "Terrain.hpp"
+#include "Fixture.hpp"
+#include "Physics.hpp"
+#include "Broadphase.hpp"
+#include "WorkerPool.hpp"
+#include "TerrainMesher.hpp"
+
+/*
+ * ssk_bench: physics benchmark on synthetic crowds.
+ *
+ * Outputs one CSV line per (distribution, entity count, strategy):
+ * bench,distribution,entities,strategy,pairs_tested,pairs_hit,ns_per_pair,ms_per_tick
+ * For the broadphase bench, pairs_tested counts the pairs whose boxes overlap, the same for every strategy,
+ * and pairs_hit those whose circles do.
+ * For the collect bench, pairs_tested counts bodies.
+ * For the generate bench, distribution is the map side, entities the room count,
+ * pairs_tested counts tiles, pairs_hit floor tiles, and a tick is one generation.
+ * For the stream bench, distribution is the window side in chunks, and a tick is one step of the window.
+ * For the mesh bench, distribution is the map side, pairs_tested counts triangles with a mesh per tile,
+ * pairs_hit meshed triangles, and a tick meshes every chunk.
+ *
+ * Usage: ssk_bench [--quick]
+ */
+
+using Clock = std::conditional<std::chrono::high_resolution_clock::is_steady,
+			       std::chrono::high_resolution_clock,
+			       std::chrono::steady_clock>::type;
+
+struct Crowd
+{
+  std::string name;
+  std::vector<Fixture> fixtures;
+};
+
+struct Result
+{
+  unsigned long pairsTested;
+  unsigned long pairsHit;
+  double nanoseconds;
+};
+
+static constexpr unsigned int const TICKS{5u};
+static constexpr unsigned int const BRUTE_FORCE_LIMIT{20000u};
+static constexpr unsigned int const SEED{420u};
+
+static std::vector<Vect<2u, unsigned int>> floorTiles(Terrain const &terrain, bool corridorsOnly)
+{
+  std::vector<Vect<2u, unsigned int>> tiles;
+
+  for (Vect<2u, unsigned int> i(0u, 0u); i[1] != terrain.getSize()[1]; ++i[1])
+    for (i[0] = 0u; i[0] != terrain.getSize()[0]; ++i[0])
+      if (!terrain.isSolid(i) && (!corridorsOnly || !terrain.getRoomId(i)))
+	tiles.push_back(i);
+  return tiles;
+}
+
+static Fixture makeFixture(Vect<2u, double> pos, std::minstd_rand &engine)
+{
+  std::uniform_real_distribution<> speed(-0.05, 0.05);
+
+  // Roughly the game's mix: projectiles are small, controllables are bigger.
+  return Fixture{std::uniform_int_distribution<>(0, 9)(engine) < 3 ? 0.2 : 0.5,
+      pos, Vect<2u, double>{speed(engine), speed(engine)}, true,
+      Collision::ENEMY, Collision::defaultMask(Collision::ENEMY)};
+}
+
+/**
+ * uniform: spread over every floor tile.
+ * clustered: gaussian blobs around a few floor tiles.
+ * corridor: only on tiles carved by corridors (room 0).
+ */
+static Crowd makeCrowd(Terrain const &terrain, std::string const &name, unsigned int count)
+{
+  std::minstd_rand engine(SEED);
+  std::vector<Vect<2u, unsigned int>> const tiles(floorTiles(terrain, name == "corridor"));
+  std::uniform_int_distribution<std::size_t> pickTile(0u, tiles.size() - 1u);
+  std::uniform_real_distribution<> inTile(0.0, 1.0);
+  Crowd crowd{name, {}};
+
+  crowd.fixtures.reserve(count);
+  if (name == "clustered")
+    {
+      std::vector<Vect<2u, double>> centers;
+      std::normal_distribution<> spread(0.0, 2.0);
+
+      for (unsigned int i(0u); i != 16u; ++i)
+	centers.push_back(Vect<2u, double>(tiles[pickTile(engine)]) + Vect<2u, double>{0.5, 0.5});
+      while (crowd.fixtures.size() != count)
+	{
+	  Vect<2u, double> const pos(centers[crowd.fixtures.size() % centers.size()]
+				     + Vect<2u, double>{spread(engine), spread(engine)});
+
+	  if (pos[0] > 0.0 && pos[1] > 0.0 && !terrain.isSolid(Vect<2u, unsigned int>(pos)))
+	    crowd.fixtures.push_back(makeFixture(pos, engine));
+	}
+    }
+  else
+    while (crowd.fixtures.size() != count)
+      crowd.fixtures.push_back(makeFixture(Vect<2u, double>(tiles[pickTile(engine)])
+					   + Vect<2u, double>{inTile(engine), inTile(engine)}, engine));
+  return crowd;
+}
+
+static Result benchBroadphase(std::vector<Fixture> fixtures, Broadphase::Strategy strategy)
+{
+  Broadphase broadphase;
+  Result result{0ul, 0ul, 0.0};
+  auto const start(Clock::now());
+
+  for (unsigned int tick(0u); tick != TICKS; ++tick)
+    {
+      broadphase.clear();
+      for (Fixture &fixture : fixtures)
+	{
+	  fixture.pos += fixture.speed;
+	  broadphase.insert(fixture.pos, fixture.radius);
+	}
+      broadphase.findPairs(strategy, [&result](Broadphase::Proxy const &a, Broadphase::Proxy const &b)
+			   {
+			     ++result.pairsTested;
+			     result.pairsHit += Physics::circleTest(a.pos, a.radius, b.pos, b.radius);
+			   });
+    }
+  result.nanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+  return result;
+}
+
+/**
+ * Full collectPairs, narrowphase included, serial or on a worker pool.
+ */
+static Result benchCollect(std::vector<Fixture> fixtures, WorkerPool *pool)
+{
+  Broadphase broadphase;
+  Result result{0ul, 0ul, 0.0};
+  auto const start(Clock::now());
+
+  for (unsigned int tick(0u); tick != TICKS; ++tick)
+    {
+      broadphase.clear();
+      for (Fixture &fixture : fixtures)
+	fixture.pos += fixture.speed;
+      broadphase.insertAll(fixtures);
+      if (pool)
+	broadphase.collectPairs(*pool);
+      else
+	broadphase.collectPairs(Broadphase::Strategy::UNIFORM_GRID);
+      result.pairsTested += fixtures.size();
+      result.pairsHit += broadphase.getPairs(Collision::ENEMY, Collision::ENEMY).size();
+    }
+  result.nanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+  return result;
+}
+
+static Result benchTerrain(Terrain &terrain, std::vector<Fixture> fixtures)
+{
+  Result result{0ul, 0ul, 0.0};
+  auto const start(Clock::now());
+
+  for (unsigned int tick(0u); tick != TICKS; ++tick)
+    for (Fixture &fixture : fixtures)
+      {
+	fixture.pos += fixture.speed;
+	++result.pairsTested;
+	terrain.correctFixture(fixture, [&result](Fixture &fixture, Vect<2u, double> dir)
+			       {
+				 ++result.pairsHit;
+				 fixture.speed -= dir * fixture.speed.scalar(dir) * 2.0;
+			       });
+      }
+  result.nanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+  return result;
+}
+
+static void report(std::string const &bench, std::string const &distribution, std::size_t entities,
+		   std::string const &strategy, Result const &result)
+{
+  std::cout << bench << ','
+	    << distribution << ','
+	    << entities << ','
+	    << strategy << ','
+	    << result.pairsTested / TICKS << ','
+	    << result.pairsHit / TICKS << ','
+	    << (result.pairsTested ? result.nanoseconds / (double)result.pairsTested : 0.0) << ','
+	    << result.nanoseconds / TICKS / 1000000.0 << std::endl;
+}
+
+static void report(std::string const &bench, Crowd const &crowd, std::string const &strategy, Result const &result)
+{
+  report(bench, crowd.name, crowd.fixtures.size(), strategy, result);
+}
+
+/**
+ * Whole generateLevel, then its derived data alone: distance field and room graph.
+ * Large maps use the pool, as the LevelPipeline does.
+ */
+static void benchGenerate(unsigned int side, unsigned int roomCount, WorkerPool &pool)
+{
+  Terrain terrain({side, side});
+  std::array<Result, 3u> results{};
+  std::array<char const *, 3u> const steps{{"generate_level", "bake_distance_field", "build_room_graph"}};
+
+  for (unsigned int tick(0u); tick != TICKS; ++tick)
+    {
+      auto const start(Clock::now());
+
+      terrain.generateLevel(SEED, roomCount, &pool);
+
+      auto const generated(Clock::now());
+
+      terrain.bakeDistanceField(&pool);
+
+      auto const baked(Clock::now());
+
+      terrain.getRoomGraph().build(terrain);
+
+      auto const built(Clock::now());
+
+      results[0].nanoseconds += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(generated - start).count();
+      results[1].nanoseconds += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(baked - generated).count();
+      results[2].nanoseconds += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(built - baked).count();
+    }
+  for (Result &result : results)
+    {
+      result.pairsTested = (unsigned long)side * side * TICKS;
+      result.pairsHit = floorTiles(terrain, false).size() * TICKS;
+    }
+  for (unsigned int i(0u); i != steps.size(); ++i)
+    report("generate", std::to_string(side), roomCount, steps[i], results[i]);
+}
+
+/**
+ * Endless window moved by one chunk each tick: chunks generated, baked, and the room graph rebuilt.
+ * Then the same moves with the next window started beforehand, as the LevelPipeline does: only the splice is timed.
+ */
+static void benchStream(unsigned int windowChunks)
+{
+  Terrain terrain;
+  Result result{0ul, 0ul, 0.0};
+  Result spliced{0ul, 0ul, 0.0};
+
+  terrain.startEndless(SEED, {windowChunks, windowChunks});
+
+  auto const start(Clock::now());
+
+  for (unsigned int tick(0u); tick != TICKS; ++tick)
+    terrain.shiftWindow({1, 0});
+  result.nanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+  for (unsigned int tick(0u); tick != TICKS; ++tick)
+    {
+      Terrain next;
+
+      next.startEndless(SEED, {windowChunks, windowChunks}, terrain.getOrigin() + Vect<2u, long>{1l, 0l});
+
+      auto const splice(Clock::now());
+
+      terrain.shiftWindow(std::move(next));
+      spliced.nanoseconds += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - splice).count();
+    }
+  for (Result *timed : {&result, &spliced})
+    {
+      timed->pairsTested = (unsigned long)windowChunks * windowChunks * Terrain::CHUNK_SIZE * Terrain::CHUNK_SIZE * TICKS;
+      timed->pairsHit = floorTiles(terrain, false).size() * TICKS;
+    }
+  report("stream", std::to_string(windowChunks), windowChunks, "shift_window", result);
+  report("stream", std::to_string(windowChunks), windowChunks, "splice_window", spliced);
+}
+
+/**
+ * Every chunk of a generated level meshed each tick.
+ */
+static void benchMesh(unsigned int side, unsigned int roomCount)
+{
+  Terrain terrain({side, side});
+  Result result{0ul, 0ul, 0.0};
+
+  terrain.generateLevel(SEED, roomCount);
+
+  auto const start(Clock::now());
+
+  for (unsigned int tick(0u); tick != TICKS; ++tick)
+    {
+      TerrainMesher::Report const meshed(TerrainMesher::report(terrain));
+
+      result.pairsTested += meshed.tileTriangles;
+      result.pairsHit += meshed.wallTriangles + meshed.floorTriangles;
+    }
+  result.nanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+  report("mesh", std::to_string(side), roomCount, "greedy", result);
+}
+
+int main(int ac, char **av)
+{
+  bool const quick(ac > 1 && std::string(av[1]) == "--quick");
+  std::vector<unsigned int> const counts(quick ?
+					 std::vector<unsigned int>{1000u, 5000u} :
+					 std::vector<unsigned int>{1000u, 2000u, 5000u, 10000u, 20000u, 50000u, 100000u});
+  Terrain terrain;
+  WorkerPool pool;
+
+  terrain.generateLevel(SEED);
+  std::cout << "bench,distribution,entities,strategy,pairs_tested,pairs_hit,ns_per_pair,ms_per_tick" << std::endl;
+  benchGenerate(100u, Terrain::DEFAULT_ROOM_COUNT, pool);
+  benchGenerate(1024u, 500u, pool);
+  if (!quick)
+    benchGenerate(Terrain::MAX_SIZE, 5000u, pool);
+  benchStream(12u);
+  benchMesh(1024u, 500u);
+  for (char const *distribution : {"uniform", "clustered", "corridor"})
+    for (unsigned int count : counts)
+      {
+	Crowd const crowd(makeCrowd(terrain, distribution, count));
+
+	if (count <= BRUTE_FORCE_LIMIT)
+	  report("broadphase", crowd, "brute_force", benchBroadphase(crowd.fixtures, Broadphase::Strategy::BRUTE_FORCE));
+	report("broadphase", crowd, "sort_and_sweep", benchBroadphase(crowd.fixtures, Broadphase::Strategy::SORT_AND_SWEEP));
+	report("broadphase", crowd, "uniform_grid", benchBroadphase(crowd.fixtures, Broadphase::Strategy::UNIFORM_GRID));
+	report("collect", crowd, "serial", benchCollect(crowd.fixtures, nullptr));
+	report("collect", crowd, "parallel", benchCollect(crowd.fixtures, &pool));
+	report("terrain", crowd, "correct_fixture", benchTerrain(terrain, crowd.fixtures));
+      }
+  return 0;
+}
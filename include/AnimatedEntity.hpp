@@ -1,6 +1,7 @@
 #ifndef ANIMATED_ENTITY_HPP
 # define ANIMATED_ENTITY_HPP
 
+# include <array>
 # include <map>
 # include <memory>
 # include <vector>
@@ -9,21 +10,36 @@
 # include "Entity.hpp"
 # include "Animations.hpp"
 
+/**
+ * Animation states are resolved from their names once, when the entity is built,
+ * per frame control indexes them by Animations::Id.
+ */
 class AnimatedEntity
 {
+  using AnimationTable = std::array<Ogre::AnimationState *, (unsigned int)Animations::Id::COUNT>;
+
   Entity entity;
+  AnimationTable animations; // nullptr for animations the mesh lacks.
   Ogre::AnimationState *mainAnimation;
   Ogre::AnimationState *targetMainAnimation;
   Ogre::Real blendDuration;
   Ogre::Real blendTimer;
   std::unique_ptr<AnimatedEntity> entityMount;
 
+  static AnimationTable resolveAnimations(Ogre::Entity &);
+
+  /**
+   * Throws std::invalid_argument when the mesh lacks the animation.
+   */
+  Ogre::AnimationState *getAnimation(Animations::Id);
+
 public:
 
   template<class... P>
   AnimatedEntity(P&&... params)
     : entity(std::forward<P>(params)...)
-    , mainAnimation(entity.getOgre()->getAnimationState(Animations::IDLE))
+    , animations(resolveAnimations(*entity.getOgre()))
+    , mainAnimation(getAnimation(Animations::IDLE))
     , targetMainAnimation(nullptr)
     , blendDuration(0.f)
     , blendTimer(0.f)
@@ -42,10 +58,10 @@ public:
   Entity const &getEntity(void) const;
 
   /// Set the main animation
-  void setMainAnimation(std::string const &s, Ogre::Real blender_duration = 0.1f, bool repeat = true);
+  void setMainAnimation(Animations::Id, Ogre::Real blender_duration = 0.1f, bool repeat = true);
 
   /// Add a sub animation to this entity
-  void addSubAnimation(std::string const &s,  bool reset = true, bool loop = false);
+  void addSubAnimation(Animations::Id,  bool reset = true, bool loop = false);
 
   /// Update all animations
   void updateAnimations(Ogre::Real);
@@ -3,84 +3,131 @@
 
 namespace Animations
 {
-  constexpr char const IDLE[] = "idle";
+  /**
+   * Every animation name, resolved once into each AnimatedEntity's table.
+   */
+  enum class Id : unsigned int
+    {
+      IDLE,
+      WALK,
+      STAND,
+      STUN,
+      WALK_RIDE,
+      STAND_RIDE,
+      ATTACK,
+      ATTACK_01,
+      TAUNT,
+      DEATH,
+      SPELL_A,
+      SPELL_B,
+      SPELL_C,
+      SPELL_D,
+      SPELL_E,
+      SPELL_CHANNEL,
+      SPELL_FORWARD,
+      SPELL_OMNI,
+      COUNT
+    };
+
+  constexpr char const *const NAMES[(unsigned int)Id::COUNT]{
+    "idle",
+    "Walk",
+    "Stand",
+    "Stun",
+    "Walk_Ride",
+    "Stand_Ride",
+    "Attack",
+    "Attack_01",
+    "Taunt",
+    "Death",
+    "Spell_A",
+    "Spell_B",
+    "Spell_C",
+    "Spell_D",
+    "Spell_E",
+    "Spell_Channel",
+    "Spell_Forward",
+    "Spell_Omni",
+  };
+
+  constexpr Id const IDLE{Id::IDLE};
 
   namespace Controllable
   {
-    constexpr char const WALK[] = "Walk";
-    constexpr char const STAND[] = "Stand";
-    constexpr char const STUN[] = "Stun";
+    constexpr Id const WALK{Id::WALK};
+    constexpr Id const STAND{Id::STAND};
+    constexpr Id const STUN{Id::STUN};
     
     namespace Player
     {
-      constexpr char const WALK_RIDE[] = "Walk_Ride";
-      constexpr char const STAND_RIDE[] = "Stand_Ride";
-      constexpr char const ATTACK[] = "Attack";
+      constexpr Id const WALK_RIDE{Id::WALK_RIDE};
+      constexpr Id const STAND_RIDE{Id::STAND_RIDE};
+      constexpr Id const ATTACK{Id::ATTACK};
     }
-    constexpr char const TAUNT[] = "Taunt";
+    constexpr Id const TAUNT{Id::TAUNT};
 
     // Archer-only animations will go here
     namespace Archer
     {
-      constexpr char const JUMP[] = "Spell_A"; // JUMP
-      constexpr char const SPELL_B[] = "Spell_B"; 
-      constexpr char const SPELL_C[] = "Spell_C";
-      constexpr char const SPELL_CHANNEL[] = "Spell_Channel";
-      constexpr char const DASH[] = "Spell_D";
-      constexpr char const SPELL_E[] = "Spell_E";
-      constexpr char const SPELL_FORWARD[] = "Spell_Forward";
-      constexpr char const SPELL_OMNI[] = "Spell_Omni";
+      constexpr Id const JUMP{Id::SPELL_A}; // JUMP
+      constexpr Id const SPELL_B{Id::SPELL_B}; 
+      constexpr Id const SPELL_C{Id::SPELL_C};
+      constexpr Id const SPELL_CHANNEL{Id::SPELL_CHANNEL};
+      constexpr Id const DASH{Id::SPELL_D};
+      constexpr Id const SPELL_E{Id::SPELL_E};
+      constexpr Id const SPELL_FORWARD{Id::SPELL_FORWARD};
+      constexpr Id const SPELL_OMNI{Id::SPELL_OMNI};
     };
 
     namespace Warrior
     {
-      constexpr char const SPELL_A[] = "Spell_A";
-      constexpr char const SPELL_B[] = "Spell_B";
-      constexpr char const JUMP[] = "Spell_C";
-      constexpr char const SPELL_CHANNEL[] = "Spell_Channel";
-      constexpr char const SPELL_D[] = "Spell_D";
-      constexpr char const HAMMER_DOWN[] = "Spell_E";
-      constexpr char const SPELL_FORWARD[] = "Spell_Forward";
-      constexpr char const SPELL_OMNI[] = "Spell_Omni";
+      constexpr Id const SPELL_A{Id::SPELL_A};
+      constexpr Id const SPELL_B{Id::SPELL_B};
+      constexpr Id const JUMP{Id::SPELL_C};
+      constexpr Id const SPELL_CHANNEL{Id::SPELL_CHANNEL};
+      constexpr Id const SPELL_D{Id::SPELL_D};
+      constexpr Id const HAMMER_DOWN{Id::SPELL_E};
+      constexpr Id const SPELL_FORWARD{Id::SPELL_FORWARD};
+      constexpr Id const SPELL_OMNI{Id::SPELL_OMNI};
     };
 
     namespace Tank
     {
-      constexpr char const SPELL_A[] = "Spell_A";
-      constexpr char const SPELL_B[] = "Spell_B";
-      constexpr char const JUMP[] = "Spell_C";
-      constexpr char const SPELL_CHANNEL[] = "Spell_Channel";
-      constexpr char const SPELL_D[] = "Spell_D";
-      constexpr char const SPELL_E[] = "Spell_E";
-      constexpr char const SPELL_FORWARD[] = "Spell_Forward";
-      constexpr char const SPELL_OMNI[] = "Spell_Omni";
+      constexpr Id const SPELL_A{Id::SPELL_A};
+      constexpr Id const SPELL_B{Id::SPELL_B};
+      constexpr Id const JUMP{Id::SPELL_C};
+      constexpr Id const SPELL_CHANNEL{Id::SPELL_CHANNEL};
+      constexpr Id const SPELL_D{Id::SPELL_D};
+      constexpr Id const SPELL_E{Id::SPELL_E};
+      constexpr Id const SPELL_FORWARD{Id::SPELL_FORWARD};
+      constexpr Id const SPELL_OMNI{Id::SPELL_OMNI};
     };
 
     namespace Mage
     {
-      constexpr char const SPELL_A[] = "Spell_A";
-      constexpr char const SPELL_B[] = "Spell_B";
-      constexpr char const SPELL_C[] = "Spell_C";
-      constexpr char const SPELL_CHANNEL[] = "Spell_Channel";
-      constexpr char const SPELL_D[] = "Spell_D";
-      constexpr char const SPELL_E[] = "Spell_E";
-      constexpr char const SPELL_FORWARD[] = "Spell_Forward";
-      constexpr char const SPELL_OMNI[] = "Spell_Omni";
+      constexpr Id const SPELL_A{Id::SPELL_A};
+      constexpr Id const SPELL_B{Id::SPELL_B};
+      constexpr Id const SPELL_C{Id::SPELL_C};
+      constexpr Id const SPELL_CHANNEL{Id::SPELL_CHANNEL};
+      constexpr Id const SPELL_D{Id::SPELL_D};
+      constexpr Id const SPELL_E{Id::SPELL_E};
+      constexpr Id const SPELL_FORWARD{Id::SPELL_FORWARD};
+      constexpr Id const SPELL_OMNI{Id::SPELL_OMNI};
     };
 
     namespace Enemy
     {
-      constexpr char const DEATH[] = "Death";
+      constexpr Id const DEATH{Id::DEATH};
 
-      constexpr char const ATTACK_01[] = "Attack";
-      constexpr char const ATTACK_02[] = "Attack_01";
+      constexpr Id const ATTACK_01{Id::ATTACK};
+      constexpr Id const ATTACK_02{Id::ATTACK_01};
     };
   }
 
   namespace Mount
   {
-    constexpr char const WALK[] = "Walk";
-    constexpr char const STAND[] = "Stand";
+    constexpr Id const WALK{Id::WALK};
+    constexpr Id const STAND{Id::STAND};
   };
 
 };
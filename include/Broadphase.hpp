@@ -0,0 +1,217 @@
+#ifndef BROADPHASE_HPP
+# define BROADPHASE_HPP
+
+# include <array>
+# include <vector>
+# include <utility>
+# include <algorithm>
+# include <cmath>
+# include "Vect.hpp"
+# include "Fixture.hpp"
+# include "WorkerPool.hpp"
+
+/**
+ * Finds the pairs of circles whose bounding boxes overlap.
+ * Bodies are inserted every tick, findPairs then reports candidates.
+ * collectPairs does the same in one pass for every collision category,
+ * keeps the pairs whose circles overlap, and buckets them by category pair.
+ * findPairs leaves the narrowphase (Physics::circleTest) to the caller.
+ * Bodies with a non finite position or radius are ignored, they can't overlap anything.
+ */
+class Broadphase
+{
+public:
+  enum class Strategy
+    {
+      BRUTE_FORCE,
+      SORT_AND_SWEEP,
+      UNIFORM_GRID
+    };
+
+  struct Proxy
+  {
+    Vect<2u, double> pos;
+    double radius;
+    unsigned int index; // insertion order, stable for the tick.
+    unsigned int category;
+    unsigned int mask;
+    unsigned int item; // index in the caller's container.
+
+    constexpr bool collidesWith(Proxy const &other) const
+    {
+      return (mask & Collision::bit(other.category)) && (other.mask & Collision::bit(category));
+    }
+
+    constexpr bool overlaps(Proxy const &other) const
+    {
+      return (std::abs(pos[0] - other.pos[0]) < radius + other.radius
+	      && std::abs(pos[1] - other.pos[1]) < radius + other.radius);
+    }
+  };
+
+private:
+  /**
+   * Below this, waking the workers costs more than it saves.
+   */
+  static constexpr unsigned int const PARALLEL_THRESHOLD{512u};
+
+  /**
+   * Largest grid built, about a 4096 tiles terrain with the default cell size.
+   * Bodies spread wider than this are swept instead.
+   */
+  static constexpr unsigned int const MAX_GRID_CELLS{1u << 22u};
+
+  std::vector<Proxy> proxies;
+  std::vector<unsigned int> order;
+
+  double cellSize;
+  Vect<2u, double> gridOrigin;
+  Vect<2u, unsigned int> gridSize;
+  std::vector<unsigned int> cellStart;
+  std::vector<unsigned int> cellEntries;
+
+  std::array<std::vector<std::pair<unsigned int, unsigned int>>,
+	     Collision::CATEGORY_COUNT * Collision::CATEGORY_COUNT> buckets;
+  std::vector<std::vector<std::pair<unsigned int, unsigned int>>> workerPairs;
+
+  /**
+   * Returns false, without building anything, when the bodies' extent needs more than MAX_GRID_CELLS.
+   */
+  bool buildGrid();
+  void narrowphase(Proxy const &a, Proxy const &b, std::vector<std::pair<unsigned int, unsigned int>> &pairs) const;
+  void fillBuckets();
+
+  constexpr Vect<2u, unsigned int> cellOf(Vect<2u, double> pos) const
+  {
+    return {(unsigned int)((pos[0] - gridOrigin[0]) / cellSize),
+	(unsigned int)((pos[1] - gridOrigin[1]) / cellSize)};
+  }
+
+  template<class RESPONSE>
+  void bruteForce(RESPONSE &&response) const
+  {
+    for (auto a(proxies.begin()); a != proxies.end(); ++a)
+      for (auto b(a + 1); b != proxies.end(); ++b)
+	if (a->overlaps(*b))
+	  response(*a, *b);
+  }
+
+  template<class RESPONSE>
+  void sortAndSweep(RESPONSE &&response)
+  {
+    order.resize(proxies.size());
+    for (unsigned int i(0u); i != order.size(); ++i)
+      order[i] = i;
+    std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b)
+	      {
+		return proxies[a].pos[0] - proxies[a].radius < proxies[b].pos[0] - proxies[b].radius;
+	      });
+    for (auto a(order.begin()); a != order.end(); ++a)
+      {
+	Proxy const &proxyA(proxies[*a]);
+	double const maxX(proxyA.pos[0] + proxyA.radius);
+
+	for (auto b(a + 1); b != order.end() && proxies[*b].pos[0] - proxies[*b].radius < maxX; ++b)
+	  {
+	    Proxy const &proxyB(proxies[*b]);
+
+	    if (proxyA.overlaps(proxyB))
+	      *a < *b ? response(proxyA, proxyB) : response(proxyB, proxyA);
+	  }
+      }
+  }
+
+  /**
+   * Bodies are stored in every cell their box touches.
+   * A pair is only reported by the cell holding the min corner of the boxes' intersection.
+   * Falls back to sortAndSweep when the grid would be too large.
+   */
+  template<class RESPONSE>
+  void uniformGrid(RESPONSE &&response)
+  {
+    if (buildGrid())
+      gridCells(0u, (unsigned int)cellStart.size() - 1u, response);
+    else
+      sortAndSweep(response);
+  }
+
+  template<class RESPONSE>
+  void gridCells(unsigned int begin, unsigned int end, RESPONSE &&response) const
+  {
+    for (unsigned int cell(begin); cell != end; ++cell)
+      for (unsigned int i(cellStart[cell]); i != cellStart[cell + 1]; ++i)
+	for (unsigned int j(i + 1); j != cellStart[cell + 1]; ++j)
+	  {
+	    Proxy const &proxyA(proxies[cellEntries[i]]);
+	    Proxy const &proxyB(proxies[cellEntries[j]]);
+	    Vect<2u, unsigned int> const owner(cellOf({std::max(proxyA.pos[0] - proxyA.radius, proxyB.pos[0] - proxyB.radius),
+			std::max(proxyA.pos[1] - proxyA.radius, proxyB.pos[1] - proxyB.radius)}));
+
+	    if (owner[0] + owner[1] * gridSize[0] == cell && proxyA.overlaps(proxyB))
+	      response(proxyA, proxyB);
+	  }
+  }
+
+public:
+  Broadphase(double cellSize = 2.0);
+
+  void clear();
+  void insert(Vect<2u, double> pos, double radius,
+	      unsigned int category = Collision::PLAYER, unsigned int mask = ~0u, unsigned int item = 0u);
+
+  /**
+   * Inserts every fixture of the container with its own category and mask.
+   * Radiuses are grown by margin, so pairs about to touch are reported too.
+   */
+  template<class CONTAINER>
+  void insertAll(CONTAINER const &container, double margin = 0.0)
+  {
+    for (unsigned int i(0u); i != container.size(); ++i)
+      insert(container[i].pos, container[i].radius + margin, container[i].category, container[i].mask, i);
+  }
+
+  std::vector<Proxy> const &getProxies() const;
+
+  /**
+   * Finds the pairs of all inserted bodies whose masks match, in one pass.
+   * Results are read with getPairs.
+   */
+  void collectPairs(Strategy strategy);
+
+  /**
+   * Same as collectPairs with the uniform grid, cells being split between the pool's workers.
+   * Each worker fills its own buffer, buffers are then merged and sorted,
+   * so the result is exactly the serial one.
+   */
+  void collectPairs(WorkerPool &pool);
+
+  /**
+   * Pairs of items (item of categoryA, item of categoryB) found by collectPairs.
+   * Pairs are sorted, so responses are applied in a deterministic order:
+   * for each item of categoryA, in order, its items of categoryB in order.
+   */
+  std::vector<std::pair<unsigned int, unsigned int>> const &getPairs(unsigned int categoryA, unsigned int categoryB) const;
+
+  /**
+   * Calls response(a, b) once for each pair whose boxes overlap, with a.index < b.index.
+   * Every strategy reports the same pairs.
+   */
+  template<class RESPONSE>
+  void findPairs(Strategy strategy, RESPONSE &&response)
+  {
+    switch (strategy)
+      {
+      case Strategy::BRUTE_FORCE:
+	bruteForce(response);
+	break;
+      case Strategy::SORT_AND_SWEEP:
+	sortAndSweep(response);
+	break;
+      case Strategy::UNIFORM_GRID:
+	uniformGrid(response);
+	break;
+      }
+  }
+};
+
+#endif
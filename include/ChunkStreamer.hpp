@@ -0,0 +1,108 @@
+#ifndef CHUNK_STREAMER_HPP
+# define CHUNK_STREAMER_HPP
+
+# include <deque>
+# include <vector>
+# include <cstdint>
+# include <utility>
+# include <unordered_map>
+# include "Terrain.hpp"
+# include "Player.hpp"
+# include "Enemy.hpp"
+
+/**
+ * Endless mode bookkeeping: when to move the terrain's window, and the enemies of the chunks it leaves behind.
+ * Enemies are archived packed, per world chunk. At most MAX_ARCHIVED chunks are remembered,
+ * older ones come back as never visited.
+ */
+class ChunkStreamer
+{
+public:
+  static constexpr unsigned int const WINDOW_CHUNKS{12u};
+
+  /**
+   * The window moves once the players get closer than this to one of its edges, in chunks.
+   */
+  static constexpr unsigned int const MARGIN{3u};
+  static constexpr unsigned int const MAX_ARCHIVED{1024u};
+
+  /**
+   * Archived positions are in 1/POSITION_SCALE of a tile, from the chunk's corner.
+   */
+  static constexpr unsigned int const POSITION_SCALE{512u};
+
+  struct PackedEnemy
+  {
+    std::uint16_t pos[2];
+    std::uint16_t health;
+    std::uint16_t maxHealth;
+    std::uint16_t ai;
+  };
+
+private:
+  struct Archive
+  {
+    unsigned long stamp;
+    std::vector<PackedEnemy> enemies;
+  };
+
+  std::unordered_map<unsigned long long, Archive> archives;
+  std::deque<std::pair<unsigned long long, unsigned long>> order; // oldest first, stale when the stamp differs.
+  unsigned long stamp;
+
+  static constexpr unsigned long long key(Vect<2u, long> world)
+  {
+    return ((unsigned long long)(unsigned int)world[0] << 32ull) | (unsigned int)world[1];
+  }
+
+  /**
+   * Whether the chunk, in the window after a move by delta, was out of the window before.
+   */
+  static bool entered(Terrain const &terrain, Vect<2u, int> delta, Vect<2u, unsigned int> chunk);
+
+public:
+  ChunkStreamer();
+
+  /**
+   * Chunks to move the window by to center it on the players, zero while they are far enough from its edges.
+   */
+  static Vect<2u, int> windowShift(Terrain const &terrain, std::vector<Player> const &players);
+
+  /**
+   * Whether pos is out of the window once it moved by delta.
+   */
+  static bool leaves(Terrain const &terrain, Vect<2u, int> delta, Vect<2u, double> pos);
+
+  /**
+   * Archives the living enemies of the chunks about to leave the window.
+   * Chunks whose room's mobs were spawned are archived even without enemies, so they don't spawn again.
+   */
+  void archive(Terrain const &terrain, Vect<2u, int> delta, std::vector<Enemy> const &enemies);
+
+  /**
+   * After the window moved by delta, marks the rooms of the archived chunks it generated as spawned,
+   * and calls spawn(packedEnemy, pos) for each of their enemies. Archives are dropped once restored.
+   */
+  template<class SPAWN>
+  void restore(Terrain &terrain, Vect<2u, int> delta, SPAWN &&spawn)
+  {
+    for (Vect<2u, unsigned int> chunk(0u, 0u); chunk[1] != terrain.getChunkCount()[1]; ++chunk[1])
+      for (chunk[0] = 0u; chunk[0] != terrain.getChunkCount()[0]; ++chunk[0])
+	{
+	  if (!entered(terrain, delta, chunk))
+	    continue ;
+
+	  auto const archive(archives.find(key(terrain.getOrigin() + Vect<2u, long>(chunk))));
+
+	  if (archive == archives.end())
+	    continue ;
+	  terrain.getRooms()[terrain.getChunkRoom(chunk)].mobsSpawned = true;
+	  for (PackedEnemy const &enemy : archive->second.enemies)
+	    spawn(enemy, Vect<2u, double>(chunk * Terrain::CHUNK_SIZE)
+		  + Vect<2u, double>{(double)enemy.pos[0], (double)enemy.pos[1]} / (double)POSITION_SCALE);
+	  archives.erase(archive);
+	}
+  }
+};
+
+#endif
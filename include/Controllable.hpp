@@ -22,8 +22,9 @@ public:
   unsigned int dePopCounter;
 
   template<class... PARAMS>
-  constexpr Controllable(unsigned int health, PARAMS &&... params)
-  : Fixture{std::forward<PARAMS>(params)..., Vect<2u, double>{0.0, 0.0}, true}
+  constexpr Controllable(unsigned int category, unsigned int health, PARAMS &&... params)
+  : Fixture{std::forward<PARAMS>(params)..., Vect<2u, double>{0.0, 0.0}, true,
+      category, Collision::defaultMask(category)}
     , input{0.0, 0.0}
     , dir{0.0, 1.0}
     , targetDir(dir)
@@ -84,6 +85,14 @@ public:
       }
   }
 
+  /**
+   * Sets the health as it was saved, unlike takeDamage it leaves the entity vulnerable.
+   */
+  constexpr void setHealth(unsigned int health)
+  {
+    this->health = health < maxHealth ? health : maxHealth;
+  }
+
   void heal(unsigned int amount)
   {
     health += amount;
@@ -0,0 +1,141 @@
+#ifndef DISTANCE_FIELD_HPP
+# define DISTANCE_FIELD_HPP
+
+# include <array>
+# include <cmath>
+# include <memory>
+# include <vector>
+# include <cstdint>
+# include "Vect.hpp"
+
+class Terrain;
+class LevelCache;
+class MappedFile;
+class WorkerPool;
+
+/**
+ * Signed distance to the closest wall, with the wall's normal, sampled RESOLUTION times per tile and axis.
+ * Negative inside walls, clamped to MAX_DISTANCE.
+ * Baked per terrain chunk, missing chunks read as deep inside a wall.
+ * Chunks loaded from the level cache are read in place from the mapped file.
+ */
+class DistanceField
+{
+public:
+  static constexpr unsigned int const RESOLUTION{2u};
+  static constexpr double const MAX_DISTANCE{2.0};
+  static constexpr double const DISTANCE_SCALE{1024.0};
+  static constexpr double const NORMAL_SCALE{127.0};
+  /**
+   * How far a position can be from its sample: half the diagonal of a sample's cell.
+   */
+  static constexpr double const SAMPLE_REACH{0.7072 / RESOLUTION};
+
+  struct Sample
+  {
+    Vect<2u, double> pos;
+    double distance;
+    Vect<2u, double> normal; // zero when no wall is close enough.
+  };
+
+private:
+  struct Packed
+  {
+    std::int16_t distance;
+    std::int8_t normal[2];
+  };
+
+  using Chunk = std::vector<Packed>;
+
+  /**
+   * Tile of the other kind a sample may be closest to, and what the sample then holds.
+   */
+  struct Candidate
+  {
+    unsigned int bit; // in bakeChunk's window: (x + REACH) + (y + REACH) * WINDOW_SIDE for the tile at offset x, y.
+    Packed inFloor;
+    Packed inWall;
+  };
+
+  /**
+   * Per sample of a tile, the tiles closer than MAX_DISTANCE, closest first, ties in row order.
+   * The first one of the other kind is the closest wall.
+   */
+  using Candidates = std::array<std::vector<Candidate>, RESOLUTION * RESOLUTION>;
+
+  static Candidates const &candidates();
+
+  /**
+   * Tiles further than this, in tiles, are at least MAX_DISTANCE away from every sample of a tile:
+   * samples sit at least half a sample's cell away from their tile's borders.
+   */
+  static constexpr int const REACH{(int)(MAX_DISTANCE + 1.0 - 0.5 / RESOLUTION)};
+  static constexpr unsigned int const WINDOW_SIDE{2u * REACH + 1u};
+  static constexpr std::uint32_t const WINDOW_MASK{(1u << (WINDOW_SIDE * WINDOW_SIDE)) - 1u};
+
+  unsigned int chunkSamples;
+  Vect<2u, unsigned int> chunkCount;
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  std::vector<Packed const *> samples; // per chunk, in chunks or in mapping.
+  std::shared_ptr<MappedFile const> mapping;
+
+  friend class LevelCache;
+
+public:
+  DistanceField();
+
+  /**
+   * Bakes every allocated chunk of the terrain, drops the others.
+   * Large terrains are split between the pool's workers when one is given.
+   */
+  void bake(Terrain const &terrain, WorkerPool *pool = nullptr);
+  void bakeChunk(Terrain const &terrain, Vect<2u, unsigned int> chunk);
+
+  /**
+   * Follows Terrain::shiftWindow: chunks move by -delta, entering ones are missing until baked.
+   */
+  void shift(Vect<2u, int> delta);
+
+  /**
+   * Solidity bits of the rows from REACH above to REACH below a chunk row,
+   * for the chunk on the left, the chunk itself and the chunk on the right.
+   */
+  using Rows = std::array<std::array<std::uint64_t, 3u>, 2u * REACH + 1u>;
+
+  static void loadRows(Terrain const &terrain, Vect<2u, unsigned int> chunk, unsigned int row, Rows &rows);
+
+  /**
+   * x from -REACH to the chunk size + REACH, dy from -REACH to REACH.
+   */
+  static bool isSolid(Rows const &rows, int x, int dy)
+  {
+    unsigned int const bit((unsigned int)(x + 64));
+
+    return (rows[(unsigned int)(dy + REACH)][bit >> 6u] >> (bit & 63u)) & 1u;
+  }
+
+  Sample sample(Vect<2u, double> pos) const
+  {
+    double const x(std::floor(pos[0] * RESOLUTION));
+    double const y(std::floor(pos[1] * RESOLUTION));
+    Sample result{{(x + 0.5) / RESOLUTION, (y + 0.5) / RESOLUTION}, -MAX_DISTANCE, {0.0, 0.0}};
+
+    if (x < 0.0 || y < 0.0)
+      return result;
+
+    Vect<2u, unsigned int> const index((unsigned int)x, (unsigned int)y);
+    Vect<2u, unsigned int> const chunk(index[0] / chunkSamples, index[1] / chunkSamples);
+
+    if (chunk[0] >= chunkCount[0] || chunk[1] >= chunkCount[1] || !samples[chunk[0] + chunk[1] * chunkCount[0]])
+      return result;
+
+    Packed const &packed(samples[chunk[0] + chunk[1] * chunkCount[0]]
+			 [index[0] % chunkSamples + (index[1] % chunkSamples) * chunkSamples]);
+
+    result.distance = packed.distance / DISTANCE_SCALE;
+    result.normal = {packed.normal[0] / NORMAL_SCALE, packed.normal[1] / NORMAL_SCALE};
+    return result;
+  }
+};
+
+#endif
@@ -17,7 +17,7 @@ public:
   Enemy() = default;
   template<class... PARAMS>
   Enemy(unsigned int ai, PARAMS &&... params)
-    : Controllable(std::forward<PARAMS>(params)...)
+    : Controllable(Collision::ENEMY, std::forward<PARAMS>(params)...)
     , ai(ai)
   {}
 
@@ -1,25 +1,32 @@
 #ifndef ENTITY_FACTORY_HPP
 # define ENTITY_FACTORY_HPP
 
+# include <memory>
 # include "Skins.hpp"
 
 class Renderer;
+class EntityPool;
+class Instance;
 class Entity;
 class AnimatedEntity;
 class ParticleEffect;
 
+/**
+ * Projectiles and pickups are hardware instanced, from a pool. Call updatePool once per frame.
+ */
 class EntityFactory
 {
 private:
   Renderer &renderer;
+  std::shared_ptr<EntityPool> pool;
 
 public:
-  constexpr EntityFactory(Renderer &renderer)
-    : renderer(renderer)
-  {}
+  EntityFactory(Renderer &renderer);
 
-  Entity spawnOgreHead(void);
-  Entity spawnProjectile(unsigned int porjectileType);
+  void updatePool(void);
+
+  Instance spawnOgreHead(void);
+  Instance spawnProjectile(unsigned int porjectileType);
   AnimatedEntity spawnHero(Skins::Skin);
   
 
@@ -0,0 +1,71 @@
+#ifndef ENTITY_POOL_HPP
+# define ENTITY_POOL_HPP
+
+# include <string>
+# include <vector>
+# include <memory>
+# include <unordered_map>
+# include <OgreSceneManager.h>
+# include <OgreInstanceManager.h>
+# include "Instance.hpp"
+
+/**
+ * Hardware instanced drawing and recycling of short lived meshes (projectiles, pickups).
+ * Each submesh of a mesh gets an instance manager, drawing it with its material's "/Instanced" variant.
+ * Released instances are hidden instead of being destroyed, and are handed back by acquire.
+ * Once per frame, each mesh's pool is grown or shrunk, by at most STEP instances,
+ * towards the peak usage of the current and previous PEAK_WINDOW frames.
+ * Instances keep a reference to the pool, so it outlives them.
+ */
+class EntityPool : public std::enable_shared_from_this<EntityPool>
+{
+public:
+  static constexpr unsigned int const PEAK_WINDOW{600u};
+  static constexpr unsigned int const STEP{16u};
+  static constexpr unsigned int const INSTANCES_PER_BATCH{256u};
+
+private:
+  using Parts = std::vector<Ogre::InstancedEntity *>; // one per submesh.
+
+  struct Bucket
+  {
+    std::vector<Ogre::InstanceManager *> managers;
+    std::vector<std::string> materials;
+    std::vector<Parts> free;
+    unsigned int inUse;
+    unsigned int peak; // of the previous window.
+    unsigned int windowPeak;
+  };
+
+  Ogre::SceneManager &sceneManager;
+  std::vector<Bucket> buckets;
+  std::unordered_map<std::string, unsigned int> bucketIds;
+  unsigned int frame;
+
+  unsigned int getBucket(std::string const &mesh);
+  Parts create(Bucket const &bucket);
+  void destroy(Parts &parts);
+
+public:
+  EntityPool(Ogre::SceneManager &sceneManager);
+  EntityPool(EntityPool const &) = delete;
+  ~EntityPool();
+
+  /**
+   * A visible instance of the mesh, at the origin with no rotation and a unit scale.
+   * The pool must be owned by a shared_ptr.
+   */
+  Instance acquire(std::string const &mesh);
+
+  /**
+   * Called by the instance's destructor, hides it until it is acquired again.
+   */
+  void release(Instance &instance);
+
+  /**
+   * Pre-warms or trims each mesh's pool, see above.
+   */
+  void nextFrame();
+};
+
+#endif
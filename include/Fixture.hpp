@@ -6,12 +6,42 @@
 class LoadGame;
 class SaveState;
 
+namespace Collision
+{
+  static constexpr unsigned int const PLAYER{0};
+  static constexpr unsigned int const ENEMY{1};
+  static constexpr unsigned int const PLAYER_PROJECTILE{2};
+  static constexpr unsigned int const ENEMY_PROJECTILE{3};
+  static constexpr unsigned int const PICKUP{4};
+  static constexpr unsigned int const CATEGORY_COUNT{5};
+
+  constexpr unsigned int bit(unsigned int category)
+  {
+    return 1u << category;
+  }
+
+  /**
+   * Categories a category collides with. This table is symmetric.
+   */
+  constexpr unsigned int defaultMask(unsigned int category)
+  {
+    return (category == PLAYER ? bit(PLAYER) | bit(ENEMY) | bit(ENEMY_PROJECTILE) | bit(PICKUP) :
+	    category == ENEMY ? bit(PLAYER) | bit(ENEMY) | bit(PLAYER_PROJECTILE) :
+	    category == PLAYER_PROJECTILE ? bit(ENEMY) :
+	    bit(PLAYER));
+  }
+};
+
 struct Fixture
 {
   double radius;
   Vect<2u, double> pos;
   Vect<2u, double> speed;
   bool collision;
+  unsigned int category;
+  unsigned int mask;
+  unsigned int roomId{~0u}; // room listing this fixture, see Terrain::updateMembers.
+  unsigned int influenceCell{~0u}; // cell counting this fixture, see InfluenceMap::move.
 
   constexpr bool doTerrainCollision()
   {
@@ -33,6 +63,11 @@ struct Fixture
     return (speed);
   }
 
+  constexpr bool collidesWith(Fixture const &other) const
+  {
+    return (mask & Collision::bit(other.category)) && (other.mask & Collision::bit(category));
+  }
+
   void  serialize(SaveState &state) const;
   void  unserialize(LoadGame &);
 };
@@ -0,0 +1,72 @@
+#ifndef FLOW_FIELD_HPP
+# define FLOW_FIELD_HPP
+
+# include <vector>
+# include <cstdint>
+# include "Vect.hpp"
+
+class Terrain;
+
+/**
+ * Distance to the closest target tile, by breadth first search over a window of the terrain.
+ * Each tile also stores the neighbour to walk to, so lookups are O(1).
+ * The field is shared by every enemy, and rebuilt whole, window included, whenever a target changes tile.
+ */
+class FlowField
+{
+public:
+  /**
+   * How far the window extends around the targets.
+   */
+  static constexpr unsigned int const REACH{48u};
+  static constexpr std::uint16_t const UNREACHABLE{0xFFFFu};
+
+private:
+  Vect<2u, int> origin;
+  Vect<2u, unsigned int> size;
+  std::vector<std::uint16_t> distances;
+  std::vector<Vect<2u, std::int8_t>> directions;
+  std::vector<unsigned int> queue;
+  std::vector<Vect<2u, unsigned int>> targets;
+
+  bool contains(Vect<2u, int> tile) const
+  {
+    return tile[0] >= origin[0] && tile[1] >= origin[1]
+      && tile[0] < origin[0] + (int)size[0] && tile[1] < origin[1] + (int)size[1];
+  }
+
+  unsigned int indexOf(Vect<2u, int> tile) const
+  {
+    return (unsigned int)(tile[0] - origin[0]) + (unsigned int)(tile[1] - origin[1]) * size[0];
+  }
+
+public:
+  FlowField();
+
+  /**
+   * Recomputes the whole field if the target tiles changed since the last call.
+   * Returns whether it did.
+   */
+  bool update(Terrain const &terrain, std::vector<Vect<2u, unsigned int>> const &targets);
+
+  /**
+   * Next tile to walk to from tile, relative to it.
+   * Zero on targets, and out of the window or when no target can be reached.
+   */
+  Vect<2u, int> getDirection(Vect<2u, int> tile) const
+  {
+    if (!contains(tile))
+      return {0, 0};
+
+    Vect<2u, std::int8_t> const direction(directions[indexOf(tile)]);
+
+    return {direction[0], direction[1]};
+  }
+
+  std::uint16_t getDistance(Vect<2u, int> tile) const
+  {
+    return contains(tile) ? distances[indexOf(tile)] : UNREACHABLE;
+  }
+};
+
+#endif
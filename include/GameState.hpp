@@ -14,7 +14,8 @@ struct GameState
   std::vector<Player> players;
   std::vector<Enemy> enemies;
   std::vector<Projectile> projectiles;
-  std::vector<Projectile> enemyProjectiles;
+  std::vector<Projectile> enemyProjectiles; // in Collision::ENEMY_PROJECTILE, only hitting players.
+  std::vector<Projectile> pickups;
 };
 
 #endif
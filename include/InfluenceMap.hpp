@@ -0,0 +1,118 @@
+#ifndef INFLUENCE_MAP_HPP
+# define INFLUENCE_MAP_HPP
+
+# include <array>
+# include <vector>
+# include "Vect.hpp"
+# include "Fixture.hpp"
+
+/**
+ * Coarse grid over the terrain counting, for each layer, the entities standing in each cell,
+ * plus a fading trace of the ones that just left.
+ * Fixtures remember their cell, so a tick only touches the cells entities moved between.
+ * Reads are O(1).
+ * Projectile danger only counts player projectiles, the ones enemies have to avoid.
+ */
+class InfluenceMap
+{
+public:
+  enum Layer : unsigned int
+    {
+      PLAYER_THREAT,
+      ENEMY_DENSITY,
+      PROJECTILE_DANGER,
+      LAYER_COUNT
+    };
+
+  /**
+   * Cells are CELL_SIZE tiles wide.
+   */
+  static constexpr unsigned int const CELL_SHIFT{2u};
+  static constexpr unsigned int const CELL_SIZE{1u << CELL_SHIFT};
+
+  /**
+   * Traces are multiplied by DECAY each tick, and forgotten after DECAY_TICKS.
+   */
+  static constexpr float const DECAY{0.98f};
+  static constexpr unsigned int const DECAY_TICKS{240u};
+
+private:
+  struct Cell
+  {
+    std::array<float, LAYER_COUNT> count;
+    std::array<float, LAYER_COUNT> trace;
+    std::array<unsigned int, LAYER_COUNT> traceTick;
+  };
+
+  Vect<2u, unsigned int> size;
+  std::vector<Cell> cells;
+  std::array<float, DECAY_TICKS> decayTable;
+  unsigned int tick;
+
+  unsigned int cellOf(Vect<2u, double> pos) const;
+  float decayed(Cell const &cell, Layer layer) const;
+  void enter(unsigned int cell, Layer layer);
+  void leave(unsigned int cell, Layer layer);
+
+public:
+  InfluenceMap();
+
+  /**
+   * Clears the map, before any fixture moved into it.
+   */
+  void resize(Vect<2u, unsigned int> terrainSize);
+
+  /**
+   * Follows the terrain's window moving by delta tiles, a multiple of CELL_SIZE:
+   * cells move by -delta, entering ones are empty. Fixtures must then follow, see follow.
+   */
+  void shift(Vect<2u, int> delta);
+
+  /**
+   * Ages the traces by one tick.
+   */
+  void nextTick();
+
+  /**
+   * Moves the fixture's weight to the cell holding it, if it changed.
+   * An inactive fixture (dead, or about to be removed) leaves its cell.
+   */
+  void move(Fixture &fixture, Layer layer, bool active);
+
+  /**
+   * Calls move for every element of the container.
+   * Must run before removing elements, so removed ones leave their cell.
+   */
+  template<class CONTAINER, class ACTIVE>
+  void update(CONTAINER &container, Layer layer, ACTIVE &&active)
+  {
+    for (auto &element : container)
+      move(element, layer, active(element));
+  }
+
+  /**
+   * After a shift, points the fixtures of the container that were in a cell to the one now holding them.
+   * Their positions must have moved along with the map.
+   */
+  template<class CONTAINER>
+  void follow(CONTAINER &container) const
+  {
+    for (auto &element : container)
+      if (element.influenceCell != ~0u)
+	element.influenceCell = cellOf(element.pos);
+  }
+
+  /**
+   * Entities standing in the cell holding pos, plus the decayed trace of those who left it.
+   * Zero outside of the map.
+   */
+  float get(Layer layer, Vect<2u, double> pos) const;
+
+  /**
+   * Center of the cell with the least influence among the one holding pos and its 8 neighbours.
+   * Ties keep pos' own cell.
+   */
+  Vect<2u, double> lowest(Layer layer, Vect<2u, double> pos) const;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef INSTANCE_HPP
+# define INSTANCE_HPP
+
+# include <vector>
+# include <memory>
+# include <OgreInstancedEntity.h>
+
+class EntityPool;
+
+/**
+ * Handle on a hardware instanced mesh, one Ogre instance per submesh, given back to its pool on destruction.
+ * Transforms are written to the instances directly, no scene node is involved.
+ * Empty handles (default constructed, moved from) draw nothing.
+ */
+class Instance
+{
+private:
+  std::vector<Ogre::InstancedEntity *> parts;
+  unsigned int bucket;
+  std::shared_ptr<EntityPool> pool;
+
+  friend class EntityPool;
+
+  Instance(std::vector<Ogre::InstancedEntity *> &&parts, unsigned int bucket, std::shared_ptr<EntityPool> pool);
+
+public:
+  Instance();
+  Instance(Instance const &) = delete;
+  Instance(Instance &&);
+  Instance &operator=(Instance const &) = delete;
+  Instance &operator=(Instance &&);
+  ~Instance();
+
+  bool isEmpty() const;
+
+  void setScale(Ogre::Real scale);
+
+  /**
+   * Orientation turning the mesh's Z axis towards (x, 0, z), as Entity::setDirection does.
+   */
+  static Ogre::Quaternion directionToOrientation(Ogre::Real x, Ogre::Real z);
+
+  void setTransform(Ogre::Vector3 const &position, Ogre::Quaternion const &orientation);
+};
+
+#endif
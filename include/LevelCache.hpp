@@ -0,0 +1,61 @@
+#ifndef LEVEL_CACHE_HPP
+# define LEVEL_CACHE_HPP
+
+# include <string>
+# include <cstdint>
+# include "Terrain.hpp"
+
+/**
+ * Generated levels saved on disk, one file per seed.
+ * Files hold the tiles, rooms and distance field of a terrain, 8 bytes aligned,
+ * so the distance field is used straight from the mapped file.
+ * The room graph is rebuilt on load.
+ */
+class LevelCache
+{
+public:
+  /**
+   * Must be bumped whenever the file layout changes.
+   */
+  static constexpr std::uint32_t const FORMAT_VERSION{1u};
+
+private:
+  struct Header
+  {
+    char magic[4];
+    std::uint32_t formatVersion;
+    std::uint32_t generatorVersion;
+    std::uint32_t seed;
+    std::uint32_t size[2];
+    std::uint32_t roomCount;
+    std::uint32_t chunkSamples;
+  };
+
+  struct PackedRoom
+  {
+    double pos[2];
+    std::uint32_t id;
+    std::uint32_t mobsSpawned;
+  };
+
+  std::string directory;
+
+  std::string getPath(unsigned int seed) const;
+
+public:
+  LevelCache(std::string const &directory = "cache");
+
+  /**
+   * Loads the level of this seed into terrain.
+   * Returns false, leaving terrain untouched, when the file is missing, truncated,
+   * or was written by another version of the generator or of the format.
+   */
+  bool load(unsigned int seed, Terrain &terrain) const;
+
+  /**
+   * Saves a generated terrain. Failures are silent, the level will just be generated again.
+   */
+  void store(Terrain const &terrain) const;
+};
+
+#endif
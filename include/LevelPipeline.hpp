@@ -0,0 +1,100 @@
+#ifndef LEVEL_PIPELINE_HPP
+# define LEVEL_PIPELINE_HPP
+
+# include <deque>
+# include <mutex>
+# include <memory>
+# include <thread>
+# include <vector>
+# include <utility>
+# include <condition_variable>
+# include "Terrain.hpp"
+# include "LevelCache.hpp"
+# include "WorkerPool.hpp"
+# include "TerrainMesher.hpp"
+
+/**
+ * Generates levels ahead of time on its own thread.
+ * Seeds are queued with prefetch, finished terrains (rooms, distance field and room graph included)
+ * wait in the ready queue with their chunks' meshes until taken, so the render thread only uploads them.
+ * Levels are read from the level cache when possible, and saved to it once generated.
+ * Large levels are generated on a worker pool kept for the pipeline's whole life.
+ * In endless mode, it starts the terrain's next window instead, see Terrain::shiftWindow.
+ */
+class LevelPipeline
+{
+public:
+  static constexpr unsigned int const FIRST_LEVEL{420u};
+
+  /**
+   * Levels kept ready at once, prefetch blocks the worker beyond that.
+   */
+  static constexpr unsigned int const MAX_READY{2u};
+
+  struct Level
+  {
+    Terrain terrain;
+    std::vector<TerrainMesher::ChunkMesh> meshes; // see TerrainMesher::meshTerrain.
+  };
+
+private:
+  std::mutex lock;
+  std::condition_variable wake;
+  std::condition_variable done;
+  std::deque<unsigned int> requests;
+  std::vector<std::pair<unsigned int, Level>> ready;
+  unsigned int generating;
+  bool busy;
+
+  struct Window
+  {
+    unsigned int seed;
+    Vect<2u, unsigned int> chunkCount;
+    Vect<2u, long> origin;
+  };
+
+  Window window; // latest window asked for.
+  bool windowQueued;
+  bool windowBusy;
+  std::unique_ptr<Terrain> readyWindow;
+  bool stop;
+  LevelCache cache;
+  WorkerPool pool;
+  std::thread thread;
+
+  void work();
+  Level build(unsigned int seed);
+  bool isReady(unsigned int seed) const;
+
+public:
+  LevelPipeline();
+  LevelPipeline(LevelPipeline const &) = delete;
+  ~LevelPipeline();
+
+  static LevelPipeline &getPipeline();
+
+  /**
+   * Queues the generation of a level, does nothing if it is already queued or ready.
+   */
+  void prefetch(unsigned int seed);
+
+  /**
+   * Hands over a level and its meshes.
+   * Waits if it is being generated, generates it on the calling thread if it was never prefetched
+   * or is still waiting in the queue.
+   */
+  Level take(unsigned int seed);
+
+  /**
+   * Queues starting the window of the terrain's seed and size at origin, before any level.
+   * Only the latest window asked for is built, and only the latest built is kept.
+   */
+  void prefetchWindow(Terrain const &terrain, Vect<2u, long> origin);
+
+  /**
+   * Hands over the window started at origin if it is ready, returns false without waiting otherwise.
+   */
+  bool takeWindow(Vect<2u, long> origin, Terrain &terrain);
+};
+
+#endif
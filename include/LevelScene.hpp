@@ -9,9 +9,12 @@
 #include "Scene.hpp"
 #include "Entity.hpp"
 #include "AnimatedEntity.hpp"
+#include "Instance.hpp"
 #include "LogicThread.hpp"
 #include "Music.hpp"
 #include "Player.hpp"
+#include "Vect.hpp"
+#include "TerrainMesher.hpp"
 
 class Terrain;
 
@@ -26,15 +29,46 @@ class LevelScene : public Scene
 private:
   UIOverlayHUD uiHUD;
   UIOverlayPause uiPause;
-  Ogre::SceneNode *terrainNode;
+  /**
+   * Meshed tiles of a terrain chunk, under a node placed at the chunk's corner.
+   * Walls cast shadows, ground doesn't. Empty meshes have no object.
+   */
+  struct TerrainChunk
+  {
+    Ogre::SceneNode *node;
+    Ogre::ManualObject *walls;
+    Ogre::ManualObject *ground;
+  };
+
+  /**
+   * Only chunks under the camera's ground footprint, grown by VISIBILITY_MARGIN tiles for wall tops
+   * and shadows past its edges, are attached to the scene. Rays missing the ground stop at FOOTPRINT_REACH.
+   */
+  static constexpr float const VISIBILITY_MARGIN{4.0f};
+  static constexpr float const FOOTPRINT_REACH{128.0f};
+
+  Ogre::SceneManager &sceneManager;
+  Ogre::Camera &camera;
+  std::vector<TerrainChunk> terrainChunks;
+  Vect<2u, unsigned int> chunkCount;
+  Vect<2u, unsigned int> visibleBegin; // chunks in [visibleBegin, visibleEnd[ are attached.
+  Vect<2u, unsigned int> visibleEnd;
+  unsigned int objectCount; // manual objects need unique names.
   bool inPause;
 
+  Ogre::ManualObject *createObject(TerrainMesher::Mesh const &, Ogre::SceneNode *, bool castShadows);
+  TerrainChunk createChunk(Vect<2u, unsigned int> chunk, TerrainMesher::ChunkMesh const &);
+  void destroyChunk(TerrainChunk const &);
+  static void moveChunk(TerrainChunk const &, Ogre::Vector3 offset);
+  void setChunkAttached(Vect<2u, unsigned int> chunk, bool attached);
+
 public:
   Ogre::SceneNode *cameraNode;
   std::vector<AnimatedEntity> players;
   std::vector<AnimatedEntity> enemies;
-  std::vector<Entity> projectiles;
-  std::vector<Entity> enemyProjectiles;
+  std::vector<Instance> projectiles;
+  std::vector<Instance> enemyProjectiles;
+  std::vector<Instance> pickups;
 
 private:
   std::vector<Ogre::Light *> lights;
@@ -50,9 +84,22 @@ public:
     std::vector<Gameplays> const &);
   virtual ~LevelScene(void);
 
-  static void createWallMesh();
-  static void createGroundMesh();
-  void setTerrain(Terrain const &);
+  /**
+   * Uploads the meshes of the terrain's chunks, built beforehand by TerrainMesher::meshTerrain.
+   */
+  void setTerrain(Terrain const &, std::vector<TerrainMesher::ChunkMesh> const &meshes);
+
+  /**
+   * Follows Terrain::shiftWindow: kept chunks and the camera move by -delta chunks,
+   * chunks left behind are destroyed and entering ones created.
+   */
+  void shiftTerrain(Terrain const &, Vect<2u, int> delta);
+
+  /**
+   * Attaches the chunks entering the camera's footprint and detaches the ones leaving it.
+   * Only chunks visible before or after are touched. Must be called after moving the camera.
+   */
+  void updateTerrainVisibility();
   virtual bool update(Game &, Ogre::FrameEvent const &) override;
   virtual void resetSceneCallbacks(Renderer &);
 
@@ -11,12 +11,18 @@
 #include "GameState.hpp"
 #include "ModVector.hpp"
 #include "EntityFactory.hpp"
+#include "Instance.hpp"
 #include "AudioSource.hpp"
 #include "PyBindInstance.hpp"
 #include "PyEvaluate.hpp"
 #include "Action.hpp"
 #include "KeyboardController.hpp"
-#include "ParticleEffect.hpp"
+#include "ParticlePool.hpp"
+#include "Physics.hpp"
+#include "Broadphase.hpp"
+#include "StaticGrid.hpp"
+#include "InfluenceMap.hpp"
+#include "ChunkStreamer.hpp"
 
 class LevelScene;
 
@@ -38,16 +44,39 @@ private:
 
   std::vector<AnimatedEntity> &playerEntities;
   ModVector<decltype(GameState::enemies)::value_type, AnimatedEntity> enemies;
-  ModVector<decltype(GameState::projectiles)::value_type, Entity> projectiles;
-  ModVector<decltype(GameState::enemyProjectiles)::value_type, Entity> enemyProjectiles;
+  ModVector<decltype(GameState::projectiles)::value_type, Instance> projectiles;
+  ModVector<decltype(GameState::enemyProjectiles)::value_type, Instance> enemyProjectiles;
+  ModVector<decltype(GameState::pickups)::value_type, Instance> pickups;
 
   std::vector<std::pair<Vect<2u, double>, std::string>> particleSpawns;
-  std::vector<std::pair<unsigned int, ParticleEffect>> particleEffects;
+  ParticlePool particlePool;
+
+  WorkerPool workerPool;
+  Broadphase broadphase;
+  StaticGrid pickupGrid;
+  InfluenceMap influenceMap;
+  double pickupAngle;
+
+  bool endless;
+  ChunkStreamer chunkStreamer;
+  Vect<2u, int> terrainShift; // chunks the window moved by since the last frame.
 
   void calculateCamera(LevelScene &);
+
+  /**
+   * Particle template trailing projectiles of the type, nullptr for none.
+   */
+  static char const *particleTrail(unsigned int projectileType);
   bool tick();
   void spawnMobGroup(Terrain::Room &room);
 
+  /**
+   * Endless mode: moves the terrain's window when the players near its edge.
+   * The next window is started on the LevelPipeline's thread, and only spliced in once ready.
+   * Entities left behind are removed, enemies archived, and the others follow the window.
+   */
+  void streamChunks();
+
 public:
   GameState gameState;
   EntityFactory entityFactory;
@@ -65,7 +94,27 @@ public:
    */
   Logic(LevelScene &levelScene, Renderer &renderer, std::vector<AnimatedEntity> &playerEntities, std::vector<PlayerId> const &, std::vector<Gameplays> const &);
 
+  /**
+   * Endless mode is enabled by setting SSK_ENDLESS, levels are then streamed instead of taken from the LevelPipeline.
+   */
+  static bool isEndless();
+
   void spawnProjectile(Vect<2u, double> pos, Vect<2u, double> speed, unsigned int type, double size = 0.2, unsigned int timeLeft = ~0u);
+
+  /**
+   * Same as spawnProjectile, in Collision::ENEMY_PROJECTILE: it hits players instead of enemies.
+   */
+  void spawnEnemyProjectile(Vect<2u, double> pos, Vect<2u, double> speed, unsigned int type, double size = 0.2, unsigned int timeLeft = ~0u);
+
+  /**
+   * Applies response to every enemy touching the shape, right away.
+   * The particle effect is spawned separately at the shape's position.
+   * Returns the number of enemies hit.
+   */
+  template<class SHAPE, class RESPONSE>
+  unsigned int areaEffect(SHAPE const &shape, Vect<2u, double> effectPos,
+			  std::string const &particle, RESPONSE &&response);
+
   void run();
   void exit();
   void updateDisplay(LevelScene &);
@@ -74,6 +123,15 @@ public:
   void unpause(void);
 };
 
+template<class SHAPE, class RESPONSE>
+unsigned int Logic::areaEffect(SHAPE const &shape, Vect<2u, double> effectPos,
+			       std::string const &particle, RESPONSE &&response)
+{
+  particleSpawns.emplace_back(effectPos, particle);
+  return Physics::areaQuery(shape, gameState.enemies.begin(), gameState.enemies.end(),
+			    std::forward<RESPONSE>(response));
+}
+
 constexpr void Controllable::update(Logic &)
 {
   if (isDead())
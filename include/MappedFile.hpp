@@ -0,0 +1,34 @@
+#ifndef MAPPED_FILE_HPP
+# define MAPPED_FILE_HPP
+
+# include <string>
+# include <vector>
+# include <cstddef>
+
+/**
+ * Read only view of a whole file, mapped in memory.
+ * Where mmap is not available, the file is read into a buffer instead.
+ */
+class MappedFile
+{
+private:
+  char const *data;
+  std::size_t size;
+# if defined _WIN32
+  std::vector<char> buffer;
+# endif
+
+public:
+  /**
+   * Throws std::runtime_error if the file can't be opened or mapped.
+   */
+  MappedFile(std::string const &path);
+  MappedFile(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+  ~MappedFile();
+
+  char const *getData() const;
+  std::size_t getSize() const;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef PARTICLE_POOL_HPP
+# define PARTICLE_POOL_HPP
+
+# include <string>
+# include <vector>
+# include <unordered_map>
+# include "ParticleEffect.hpp"
+
+class EntityFactory;
+
+/**
+ * Particle systems kept ready per template, restarted instead of being created for each effect.
+ * A one shot effect lives LIFETIME ticks, and stops emitting for its last FADE_TICKS.
+ * A trail follows an entity until a frame goes by without moveTrail, then fades.
+ * At most CAP effects of a template exist; past it, the oldest one shot effect is cleared and restarted.
+ * Finished effects are detached from the scene until reused.
+ */
+class ParticlePool
+{
+public:
+  static constexpr unsigned int const LIFETIME{30u};
+  static constexpr unsigned int const FADE_TICKS{10u};
+  static constexpr unsigned int const CAP{32u};
+
+  /**
+   * One shot effects started within COALESCE_TICKS and COALESCE_RADIUS of another of their template are merged into it.
+   */
+  static constexpr unsigned int const COALESCE_TICKS{10u};
+  static constexpr float const COALESCE_RADIUS{1.0f};
+
+  /**
+   * Effects started per frame, trails included. Further one shot effects are dropped, further trails wait.
+   */
+  static constexpr unsigned int const FRAME_BUDGET{8u};
+  static constexpr unsigned int const NO_TRAIL{~0u};
+
+private:
+  struct Slot
+  {
+    ParticleEffect effect;
+    unsigned int ticksLeft; // 0 when free, unused by trails.
+    unsigned long started;
+    unsigned long startTick;
+    bool trail;
+    bool seen; // trails moved this frame.
+  };
+
+  struct Template
+  {
+    std::string name;
+    std::vector<Slot> slots;
+    std::vector<unsigned int> free;
+  };
+
+  std::vector<Template> templates;
+  std::unordered_map<std::string, unsigned int> templateIds;
+  unsigned long started;
+  unsigned long tick;
+  unsigned int budget;
+  unsigned long coalesced;
+  unsigned long dropped;
+
+  unsigned int getTemplate(std::string const &temp);
+
+  /**
+   * Slot to start an effect in, CAP when every slot holds a trail.
+   */
+  unsigned int acquire(EntityFactory &entityFactory, Template &pool);
+  void start(Slot &slot, Ogre::Vector3 pos, bool trail);
+  static void stop(Slot &slot);
+
+public:
+  ParticlePool();
+  ParticlePool(ParticlePool const &) = delete;
+  ~ParticlePool();
+
+  /**
+   * Starts a one shot effect of the template at pos, unless coalesced or out of budget.
+   */
+  void spawn(EntityFactory &entityFactory, std::string const &temp, Ogre::Vector3 pos);
+
+  /**
+   * Starts a trail, NO_TRAIL when out of budget or capacity: try again next frame.
+   */
+  unsigned int startTrail(EntityFactory &entityFactory, std::string const &temp, Ogre::Vector3 pos);
+
+  /**
+   * Must be called every frame while the trail's entity lives.
+   */
+  void moveTrail(unsigned int trail, Ogre::Vector3 pos);
+
+  /**
+   * Moves the running effects, and the particles they already emitted, by offset.
+   */
+  void shift(Ogre::Vector3 offset);
+
+  /**
+   * Ages the effects by ticks, stopping the finished ones and the trails left behind, and resets the budget.
+   * Called once per frame, after the frame's spawns.
+   */
+  void update(unsigned int ticks);
+};
+
+#endif
@@ -1,8 +1,10 @@
 #ifndef PHYSICS_HPP
 # define PHYSICS_HPP
 
+#include <cmath>
 #include "Iterators.hpp"
 #include "Vect.hpp"
+#include "Util.hpp"
 
 namespace Physics
 {
@@ -16,6 +18,124 @@ namespace Physics
     return (posB - posA).length2() < (radiusA + radiusB) * (radiusA + radiusB);
   }
 
+  /**
+   * Squared distance between a point and the segment [start, end].
+   */
+  constexpr double segmentDistance2(Vect<2u, double> pos,
+				    Vect<2u, double> start, Vect<2u, double> end)
+  {
+    Vect<2u, double> const seg(end - start);
+    double const len2(seg.length2());
+    double const t(len2 > 0.0 ? clamp((pos - start).scalar(seg) / len2, 0.0, 1.0) : 0.0);
+
+    return (pos - (start + seg * t)).length2();
+  }
+
+  /**
+   * Area shapes for areaQuery.
+   * `touches` tells if a circle (usually a body) overlaps the area.
+   */
+  struct Circle
+  {
+    Vect<2u, double> center;
+    double radius;
+
+    constexpr bool touches(Vect<2u, double> pos, double radius) const
+    {
+      return circleTest(center, this->radius, pos, radius);
+    }
+  };
+
+  /**
+   * Circular sector of given radius, opening `2 * halfAngle` around `dir`.
+   */
+  struct Cone
+  {
+    Vect<2u, double> center;
+    Vect<2u, double> dir;
+    double radius;
+    double cosHalfAngle;
+    Vect<2u, Vect<2u, double>> edges;
+
+    Cone(Vect<2u, double> center, Vect<2u, double> dir, double radius, double halfAngle)
+      : center(center)
+      , dir(dir.normalized())
+      , radius(radius)
+      , cosHalfAngle(std::cos(halfAngle))
+      , edges{Vect<2u, double>{this->dir[0] * cosHalfAngle - this->dir[1] * std::sin(halfAngle),
+			       this->dir[0] * std::sin(halfAngle) + this->dir[1] * cosHalfAngle} * radius,
+	  Vect<2u, double>{this->dir[0] * cosHalfAngle + this->dir[1] * std::sin(halfAngle),
+			   -this->dir[0] * std::sin(halfAngle) + this->dir[1] * cosHalfAngle} * radius}
+    {}
+
+    constexpr bool touches(Vect<2u, double> pos, double radius) const
+    {
+      Vect<2u, double> const diff(pos - center);
+      double const along(diff.scalar(dir));
+
+      if (!circleTest(center, this->radius, pos, radius))
+	return false;
+      if (along >= 0.0 && along * along >= cosHalfAngle * cosHalfAngle * diff.length2())
+	return true;
+      return (segmentDistance2(pos, center, center + edges[0]) < radius * radius
+	      || segmentDistance2(pos, center, center + edges[1]) < radius * radius);
+    }
+  };
+
+  /**
+   * Segment swept by a circle of radius `width` (capsule).
+   */
+  struct Segment
+  {
+    Vect<2u, double> start;
+    Vect<2u, double> end;
+    double width;
+
+    constexpr bool touches(Vect<2u, double> pos, double radius) const
+    {
+      return segmentDistance2(pos, start, end) < (width + radius) * (width + radius);
+    }
+  };
+
+  /**
+   * Calls response on every collidable item touching the area.
+   * Returns the number of items hit.
+   */
+  template<class SHAPE, class IT, class RESPONSE>
+  constexpr unsigned int areaQuery(SHAPE const &shape, IT begin, IT end,
+				   RESPONSE &&response)
+  {
+    unsigned int hits(0u);
+
+    for (; begin != end; ++begin)
+      if (begin->doCollision() && shape.touches(begin->getPos(), begin->getRadius()))
+	{
+	  response(*begin);
+	  ++hits;
+	}
+    return hits;
+  }
+
+  /**
+   * Narrowphase over pairs of indexes found by a Broadphase.
+   * Tests are done against current positions, so earlier responses are taken into account.
+   */
+  template<class PAIRS, class CONTAINER_A, class CONTAINER_B, class RESPONSE>
+  constexpr void pairTest(PAIRS const &pairs,
+			  CONTAINER_A &containerA, CONTAINER_B &containerB,
+			  RESPONSE &&response)
+  {
+    for (auto const &pair : pairs)
+      {
+	auto &a(containerA[pair.first]);
+	auto &b(containerB[pair.second]);
+
+	if (a.doCollision() && b.doCollision()
+	    && circleTest(a.getPos(), a.getRadius(), b.getPos(), b.getRadius()))
+	  response(a, b);
+      }
+  }
+
   template<class IT_A, class IT_B, class RESPONSE>
   constexpr void collisionTest(IT_A beginA, IT_A endA,
 			       IT_B beginB, IT_B endB,
@@ -42,6 +162,34 @@ namespace Physics
 	  response(*begin, *begin2);
   }
 
+  /**
+   * Same as pairTest, for responses that can change the radius of the first item (projectiles exploding).
+   * Once that happens the pairs left for that item are stale,
+   * it is instead tested against every following item of containerB, as collisionTest would.
+   */
+  template<class PAIRS, class CONTAINER_A, class CONTAINER_B, class RESPONSE>
+  constexpr void resizingPairTest(PAIRS const &pairs,
+				  CONTAINER_A &containerA, CONTAINER_B &containerB,
+				  RESPONSE &&response)
+  {
+    for (auto pair(pairs.begin()); pair != pairs.end(); ++pair)
+      {
+	auto &a(containerA[pair->first]);
+	auto &b(containerB[pair->second]);
+	auto const radius(a.getRadius());
+
+	if (!a.doCollision() || !b.doCollision()
+	    || !circleTest(a.getPos(), a.getRadius(), b.getPos(), b.getRadius()))
+	  continue ;
+	response(a, b);
+	if (a.getRadius() == radius)
+	  continue ;
+	collisionTest(&a, &a + 1, containerB.begin() + pair->second + 1, containerB.end(), response);
+	while (pair + 1 != pairs.end() && (pair + 1)->first == pair->first)
+	  ++pair;
+      }
+  }
+
   template<class ITEM, class POS_EXTRACTOR, class RADIUS_EXTRACTOR>
   struct PosAndRadiusProxy
   {
@@ -26,7 +26,7 @@ private:
 public:
   template<class... PARAMS>
   Player(PlayerId id, Vect<3u, Spell> &&spells, PARAMS &&... params)
-    : Controllable(std::forward<PARAMS>(params)...)
+    : Controllable(Collision::PLAYER, std::forward<PARAMS>(params)...)
     , id(static_cast<int>(id))
     , ai(0)
     , mounted(false)
@@ -1,13 +1,12 @@
 #ifndef PROJECTILE_HPP
 # define PROJECTILE_HPP
 
-# include <functional>
-# include <unordered_map>
+# include <utility>
 
 # include "Fixture.hpp"
+# include "Controllable.hpp"
 
 class SaveState;
-class Controllable;
 class Logic;
 class Projectile;
 
@@ -26,6 +25,20 @@ namespace ProjectileType
   static constexpr unsigned int const EXPLOSION{10};
   static constexpr unsigned int const HIT1{11};
   static constexpr unsigned int const HIT2{12};
+  static constexpr unsigned int const COUNT{13};
+
+  /**
+   * Drops lying on the ground, waiting for a player.
+   */
+  constexpr bool isPickup(unsigned int type)
+  {
+    return type >= COOLDOWN_RESET && type <= GOLD50;
+  }
+
+  constexpr unsigned int category(unsigned int type)
+  {
+    return isPickup(type) ? Collision::PICKUP : Collision::PLAYER_PROJECTILE;
+  }
 };
 
 class Projectile : public Fixture
@@ -33,12 +46,14 @@ class Projectile : public Fixture
 public:
   unsigned int type;
   unsigned int timeLeft;
+  unsigned int trail{~0u}; // particle trail following it, set by the display.
 
   Projectile() = default;
 
   constexpr Projectile(Vect<2u, double> pos, Vect<2u, double> speed,
 		       unsigned int type, double size = 0.2, unsigned int removeIn = ~0u)
-  : Fixture{size, pos, speed, true}
+  : Fixture{size, pos, speed, true, ProjectileType::category(type),
+      Collision::defaultMask(ProjectileType::category(type))}
     , type(type)
     , timeLeft(removeIn)
   {
@@ -84,14 +99,6 @@ public:
   void   unserialize(LoadGame &);
 };
 
-class Enemy;
-
-struct ProjectileReaction
-{
-  std::function<void(Controllable &, Projectile &)> hitEnemy;
-  std::function<void(Projectile &, Vect<2u, double>)> wallResponse;
-};
-
 /**
  * bounciness: 0.0 follow wall, 1.0, bounce back at same speed.
  */
@@ -106,14 +113,234 @@ struct BounceResponse
   }
 };
 
+/**
+ * Behaviour of a projectile type, one specialization per type.
+ * Types without specialization do nothing.
+ */
+template<unsigned int TYPE>
+struct ProjectileReaction
+{
+  static void hitEnemy(Controllable &, Projectile &)
+  {
+  }
+
+  static void wallResponse(Projectile &, Vect<2u, double>)
+  {
+  }
+};
+
+template<>
+struct ProjectileReaction<ProjectileType::ARROW>
+{
+  static void hitEnemy(Controllable &controllable, Projectile &projectile)
+  {
+    controllable.knockback(projectile.speed.normalized() * 0.2, 10);
+    controllable.takeDamage(35);
+    projectile.remove();
+  }
+
+  static void wallResponse(Projectile &projectile, Vect<2u, double>)
+  {
+    projectile.remove();
+  }
+};
+
+template<>
+struct ProjectileReaction<ProjectileType::BOUNCY_ARROW>
+{
+  static void hitEnemy(Controllable &controllable, Projectile &projectile)
+  {
+    controllable.knockback(projectile.speed.normalized() * 0.2, 10);
+    controllable.takeDamage(35);
+    BounceResponse{0.8}(projectile, (controllable.pos - projectile.pos).normalized());
+  }
+
+  static void wallResponse(Projectile &projectile, Vect<2u, double> dir)
+  {
+    BounceResponse{0.8}(projectile, dir);
+  }
+};
+
+template<>
+struct ProjectileReaction<ProjectileType::ICE_PILLAR>
+{
+  static void hitEnemy(Controllable &controllable, Projectile &projectile)
+  {
+    controllable.knockback((controllable.pos - projectile.pos).normalized() * 0.3, 5);
+    controllable.takeDamage(5);
+  }
+
+  static void wallResponse(Projectile &, Vect<2u, double>)
+  {
+  }
+};
+
+template<>
+struct ProjectileReaction<ProjectileType::FIRE_BALL> // TODO
+{
+  static void explode(Projectile &projectile)
+  {
+    projectile.timeLeft = 2;
+    projectile.type = ProjectileType::EXPLOSION;
+    projectile.radius = 2.0;
+  }
+
+  static void hitEnemy(Controllable &, Projectile &projectile)
+  {
+    explode(projectile);
+  }
+
+  static void wallResponse(Projectile &projectile, Vect<2u, double>)
+  {
+    explode(projectile);
+  }
+};
+
+template<>
+struct ProjectileReaction<ProjectileType::EXPLOSION> // TODO
+{
+  static void hitEnemy(Controllable &controllable, Projectile &projectile)
+  {
+    controllable.knockback((controllable.pos - projectile.pos).normalized() * 0.2, 5);
+    controllable.takeDamage(40);
+  }
+
+  static void wallResponse(Projectile &, Vect<2u, double>)
+  {
+  }
+};
+
+/**
+ * Pickups disappear once taken, gold and cooldowns are handled by Logic.
+ */
+struct PickupReaction
+{
+  static void hitEnemy(Controllable &, Projectile &projectile)
+  {
+    projectile.remove();
+  }
+
+  static void wallResponse(Projectile &, Vect<2u, double>)
+  {
+  }
+};
+
+template<>
+struct ProjectileReaction<ProjectileType::COOLDOWN_RESET> : public PickupReaction
+{
+};
+
+template<>
+struct ProjectileReaction<ProjectileType::GOLD> : public PickupReaction
+{
+};
+
+template<>
+struct ProjectileReaction<ProjectileType::GOLD5> : public PickupReaction
+{
+};
+
+template<>
+struct ProjectileReaction<ProjectileType::GOLD20> : public PickupReaction
+{
+};
+
+template<>
+struct ProjectileReaction<ProjectileType::GOLD50> : public PickupReaction
+{
+};
+
+template<>
+struct ProjectileReaction<ProjectileType::HEAL>
+{
+  static void hitEnemy(Controllable &controllable, Projectile &projectile)
+  {
+    controllable.heal(100);
+    projectile.remove();
+  }
+
+  static void wallResponse(Projectile &, Vect<2u, double>)
+  {
+  }
+};
+
+template<unsigned int DAMAGE, unsigned int STUN>
+struct MeleeReaction
+{
+  static void hitEnemy(Controllable &controllable, Projectile &projectile)
+  {
+    controllable.knockback(projectile.speed, STUN);
+    controllable.takeDamage(DAMAGE);
+    projectile.remove();
+  }
+
+  static void wallResponse(Projectile &projectile, Vect<2u, double>)
+  {
+    projectile.remove();
+  }
+};
+
+template<>
+struct ProjectileReaction<ProjectileType::HIT1> : public MeleeReaction<35u, 10u>
+{
+};
+
+template<>
+struct ProjectileReaction<ProjectileType::HIT2> : public MeleeReaction<105u, 30u>
+{
+};
+
+/**
+ * Static dispatch from a runtime type to its ProjectileReaction.
+ * Compiles down to a chain of compares with inlined calls.
+ */
 class ProjectileList
 {
 private:
-  std::unordered_map<unsigned int, ProjectileReaction> map;
+  template<unsigned int TYPE, bool END = TYPE == ProjectileType::COUNT>
+  struct Dispatch
+  {
+    template<class FUNC>
+    static void apply(unsigned int type, FUNC &&func)
+    {
+      if (type == TYPE)
+	func(ProjectileReaction<TYPE>{});
+      else
+	Dispatch<TYPE + 1u>::apply(type, std::forward<FUNC>(func));
+    }
+  };
+
+  template<unsigned int TYPE>
+  struct Dispatch<TYPE, true>
+  {
+    template<class FUNC>
+    static void apply(unsigned int, FUNC &&)
+    {
+    }
+  };
 
 public:
-  ProjectileList();
-  ProjectileReaction const &operator[](unsigned int) const;
+  template<class FUNC>
+  static void dispatch(unsigned int type, FUNC &&func)
+  {
+    Dispatch<0u>::apply(type, std::forward<FUNC>(func));
+  }
+
+  static void hitEnemy(Controllable &controllable, Projectile &projectile)
+  {
+    dispatch(projectile.type, [&controllable, &projectile](auto reaction)
+	     {
+	       decltype(reaction)::hitEnemy(controllable, projectile);
+	     });
+  }
+
+  static void wallResponse(Projectile &projectile, Vect<2u, double> dir)
+  {
+    dispatch(projectile.type, [&projectile, dir](auto reaction)
+	     {
+	       decltype(reaction)::wallResponse(projectile, dir);
+	     });
+  }
 };
 
 #endif
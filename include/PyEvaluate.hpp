@@ -4,22 +4,111 @@
 #include <vector>
 #include "Player.hpp"
 #include "Enemy.hpp"
+#include "Projectile.hpp"
 #include "Terrain.hpp"
+#include "FlowField.hpp"
+#include "InfluenceMap.hpp"
 
 struct PyEvaluate
 {
-  PyEvaluate(std::vector<Player> &, std::vector<Enemy> &, Terrain &terrain);
+  static constexpr unsigned int const NO_ENEMY{~0u};
+
+  PyEvaluate(std::vector<Player> &, std::vector<Enemy> &, std::vector<Projectile> &pickups, Terrain &terrain,
+	     InfluenceMap const &influenceMap);
   ~PyEvaluate() = default;
 
   Vect<2u, double> closestPlayer(Vect<2u, double> pos) const;
   Vect<2u, double> furtherPlayer(Vect<2u, double> pos) const;
   Vect<2u, double> closestEnemy(Vect<2u, double> pos) const;
   Vect<2u, double> followRightWall(Vect<2u, double> pos) const;
+  bool lineOfSight(Vect<2u, double> a, Vect<2u, double> b) const;
+
+  /**
+   * Room queries, only looking at the members of the room holding pos.
+   */
+  unsigned int playersInRoom(Vect<2u, double> pos) const;
+  unsigned int enemiesInRoom(Vect<2u, double> pos) const;
+  Vect<2u, double> closestEnemyInRoom(Vect<2u, double> pos) const;
+  Vect<2u, double> closestPickupInRoom(Vect<2u, double> pos) const;
+
+  /**
+   * Influence map reads: entities in the few tiles around pos, and how many just left them.
+   */
+  float playerThreat(Vect<2u, double> pos) const;
+  float enemyDensity(Vect<2u, double> pos) const;
+  float projectileDanger(Vect<2u, double> pos) const;
+
+  /**
+   * Center of the neighbouring cell with the fewest projectiles, pos if its own cell is the safest.
+   */
+  Vect<2u, double> safestCell(Vect<2u, double> pos) const;
+
+  /**
+   * Raycasts from every enemy to its closest player, in one batch.
+   * Called once per tick, before the AI runs.
+   */
+  void updateVisibility();
+
+  /**
+   * Result of updateVisibility's raycast for the enemy of that index.
+   */
+  bool enemySeesClosestPlayer(unsigned int enemy) const;
+
+  /**
+   * Cached for the enemy whose AI runs (see currentEnemy), raycasted on the spot for others.
+   */
+  bool seesClosestPlayer(Controllable const &) const;
+
+  /**
+   * Recomputes the flow field toward living players when one of them changed tile.
+   */
+  void updateFlowField();
+
+  /**
+   * Direction to walk toward the closest player, around walls.
+   * Zero next to a player, or when the flow field doesn't reach pos.
+   */
+  Vect<2u, double> flowDirection(Vect<2u, double> pos) const;
+
+  /**
+   * Direction to walk from one position to another, planned over rooms then tiles.
+   * Zero when there is no path.
+   */
+  Vect<2u, double> pathTowards(Vect<2u, double> from, Vect<2u, double> to);
 
   std::vector<Player> &players;
   std::vector<Enemy> &enemies;
+  std::vector<Projectile> &pickups;
   Terrain &terrain;
+  InfluenceMap const &influenceMap;
   bool attack;
+  unsigned int currentEnemy; // index of the enemy whose AI runs, set by Logic, NO_ENEMY otherwise.
+
+private:
+  Terrain::Room const &roomAt(Vect<2u, double> pos) const;
+
+  template<class CONTAINER>
+  Vect<2u, double> closestInRoom(Vect<2u, double> pos, CONTAINER const &container, Terrain::Members members) const
+  {
+    Vect<2u, double> closest(pos);
+    double closestDistance(-1.0);
+
+    for (unsigned int i : roomAt(pos).*members)
+      {
+	double const distance((container[i].pos - pos).length2());
+
+	if (distance != 0.0 && (closestDistance < 0.0 || distance < closestDistance))
+	  {
+	    closest = container[i].pos;
+	    closestDistance = distance;
+	  }
+      }
+    return closest;
+  }
+
+  Terrain::RayBatch rays;
+  FlowField flowField;
+  std::vector<Vect<2u, unsigned int>> playerTiles;
 };
 
 #endif // !PYEVALUATE_HPP_
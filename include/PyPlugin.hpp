@@ -45,6 +45,18 @@ namespace PyPlugin
       .def("closestEnemy", &PyEvaluate::closestEnemy)
       .def("furtherPlayer", &PyEvaluate::furtherPlayer)
       .def("followRightWall", &PyEvaluate::followRightWall)
+      .def("lineOfSight", &PyEvaluate::lineOfSight)
+      .def("playersInRoom", &PyEvaluate::playersInRoom)
+      .def("enemiesInRoom", &PyEvaluate::enemiesInRoom)
+      .def("closestEnemyInRoom", &PyEvaluate::closestEnemyInRoom)
+      .def("closestPickupInRoom", &PyEvaluate::closestPickupInRoom)
+      .def("playerThreat", &PyEvaluate::playerThreat)
+      .def("enemyDensity", &PyEvaluate::enemyDensity)
+      .def("projectileDanger", &PyEvaluate::projectileDanger)
+      .def("safestCell", &PyEvaluate::safestCell)
+      .def("seesClosestPlayer", &PyEvaluate::seesClosestPlayer)
+      .def("flowDirection", &PyEvaluate::flowDirection)
+      .def("pathTowards", &PyEvaluate::pathTowards)
       .def_readwrite("attack", &PyEvaluate::attack)
       ;
 
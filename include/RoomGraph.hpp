@@ -0,0 +1,81 @@
+#ifndef ROOM_GRAPH_HPP
+# define ROOM_GRAPH_HPP
+
+# include <vector>
+# include <unordered_map>
+# include "Vect.hpp"
+
+class Terrain;
+
+/**
+ * Which rooms touch which, through which tiles.
+ * Nodes are regions: connected parts of a room within a CLUSTER_SIZE square.
+ * Clusters keep corridors (all in room 0) from making one region spanning the map,
+ * and bound the local searches.
+ * Paths are planned over regions first, with an A* toward the destination region,
+ * then refined with a small tile A* up to the next portal.
+ * The first portal of each asked pair of regions is cached, up to CACHED_PAIRS pairs.
+ */
+class RoomGraph
+{
+public:
+  struct Portal
+  {
+    unsigned int region; // region on the other side.
+    Vect<2u, unsigned int> from; // last tile before crossing.
+    Vect<2u, unsigned int> to; // first tile after crossing.
+    double cost;
+  };
+
+  /**
+   * Tiles the local A* may expand before giving up.
+   */
+  static constexpr unsigned int const LOCAL_SEARCH_LIMIT{4096u};
+  static constexpr unsigned int const CLUSTER_SIZE{16u};
+  static constexpr unsigned int const NO_REGION{~0u};
+  static constexpr unsigned int const CACHED_PAIRS{1u << 14u};
+
+private:
+  Vect<2u, unsigned int> chunkCount;
+  std::vector<std::vector<unsigned int>> regions; // per terrain chunk, empty when not allocated.
+  std::vector<Vect<2u, double>> centers;
+  std::vector<std::vector<Portal>> portals;
+  std::unordered_map<unsigned long long, int> nextPortal; // index in portals[from], -1 if unreachable.
+
+  // Region A* state, only valid where stamps holds the current stamp, so searches don't clear it.
+  std::vector<double> costs;
+  std::vector<int> firstPortals;
+  std::vector<unsigned int> stamps;
+  unsigned int stamp;
+
+  int searchNextPortal(unsigned int from, unsigned int to);
+  int planNextPortal(unsigned int from, unsigned int to);
+
+public:
+  RoomGraph();
+
+  /**
+   * Flood fills the regions of the terrain's allocated chunks, then finds where they touch.
+   * One portal is kept per pair of regions, in the middle of their shared border.
+   */
+  void build(Terrain const &terrain);
+
+  unsigned int getRegion(Vect<2u, unsigned int> tile) const;
+  unsigned int getRegionCount() const;
+  std::vector<Portal> const &getPortals(unsigned int region) const;
+
+  /**
+   * Tile to walk to next on the way from one tile to another.
+   * Returns from when no path was found.
+   */
+  Vect<2u, unsigned int> nextStep(Terrain const &terrain, Vect<2u, unsigned int> from, Vect<2u, unsigned int> to);
+
+  /**
+   * A* over the tiles of one region, limited to LOCAL_SEARCH_LIMIT expansions.
+   * Returns the first step, or from when to can't be reached.
+   */
+  Vect<2u, unsigned int> localStep(Terrain const &terrain, unsigned int region,
+				   Vect<2u, unsigned int> from, Vect<2u, unsigned int> to) const;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef STATIC_GRID_HPP
+# define STATIC_GRID_HPP
+
+# include <cmath>
+# include <vector>
+# include <unordered_map>
+# include "Vect.hpp"
+
+/**
+ * Persistent spatial index for bodies that never move.
+ * Items are inserted once, and only need a rebuild when their indexes change.
+ * Each item lives in the cell holding its center, queries widen by the biggest radius.
+ */
+class StaticGrid
+{
+private:
+  double cellSize;
+  double maxRadius;
+  std::unordered_map<unsigned long long, std::vector<unsigned int>> cells;
+
+  long long cellOf(double coord) const
+  {
+    return (long long)std::floor(coord / cellSize);
+  }
+
+  static constexpr unsigned long long key(long long x, long long y)
+  {
+    return ((unsigned long long)(unsigned int)x << 32ull) | (unsigned int)y;
+  }
+
+  void eraseEmptyCells();
+
+public:
+  StaticGrid(double cellSize = 2.0);
+
+  /**
+   * Empties the cells, keeping them allocated.
+   */
+  void clear();
+  void insert(Vect<2u, double> pos, double radius, unsigned int item);
+
+  /**
+   * Clears then inserts every fixture of the container, the item being its index.
+   * Cells left empty are erased, so bodies moved elsewhere (the endless window shifting) don't grow the map.
+   */
+  template<class CONTAINER>
+  void rebuild(CONTAINER const &container)
+  {
+    clear();
+    for (unsigned int i(0u); i != container.size(); ++i)
+      insert(container[i].pos, container[i].radius, i);
+    eraseEmptyCells();
+  }
+
+  /**
+   * Calls func(item) for every item whose cell may touch the circle.
+   * The narrowphase is left to the caller.
+   */
+  template<class FUNC>
+  void query(Vect<2u, double> pos, double radius, FUNC &&func) const
+  {
+    double const reach(radius + maxRadius);
+
+    for (long long y(cellOf(pos[1] - reach)); y <= cellOf(pos[1] + reach); ++y)
+      for (long long x(cellOf(pos[0] - reach)); x <= cellOf(pos[0] + reach); ++x)
+	{
+	  auto const cell(cells.find(key(x, y)));
+
+	  if (cell != cells.end())
+	    for (unsigned int item : cell->second)
+	      func(item);
+	}
+  }
+};
+
+#endif
@@ -1,9 +1,23 @@
 #ifndef TERRAIN_HPP
 # define TERRAIN_HPP
 
+#include <array>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
 #include "Vect.hpp"
 #include "Util.hpp"
+#include "DistanceField.hpp"
+#include "RoomGraph.hpp"
 
+class LevelCache;
+class WorkerPool;
+
+/**
+ * Tiles are stored in square chunks, allocated on first write.
+ * Missing chunks and tiles out of the terrain are solid, in room 0.
+ */
 class Terrain
 {
 public:
@@ -13,92 +27,381 @@ public:
     unsigned int roomId;
   };
 
+  /**
+   * Segments to raycast, and results, as structure of arrays.
+   * distance is where the segment enters a solid tile, or its length when nothing is hit.
+   */
+  struct RayBatch
+  {
+    std::vector<double> startX;
+    std::vector<double> startY;
+    std::vector<double> endX;
+    std::vector<double> endY;
+
+    std::vector<double> distance;
+    std::vector<unsigned int> tileX;
+    std::vector<unsigned int> tileY;
+    std::vector<unsigned char> hit;
+
+    void clear();
+    void add(Vect<2u, double> start, Vect<2u, double> end);
+    std::size_t size() const;
+  };
+
   struct Room
   {
     Vect<2, double> pos;
     unsigned int id;
     bool mobsSpawned;
+    // Indexes in the game state's containers, maintained by updateMembers.
+    std::vector<unsigned int> players;
+    std::vector<unsigned int> enemies;
+    std::vector<unsigned int> pickups;
 
-    constexpr Room(Vect<2u, double> pos, unsigned int id = 0, bool mobsSpawned = true)
+    Room(Vect<2u, double> pos, unsigned int id = 0, bool mobsSpawned = true)
     : pos(pos)
       , id(id)
       , mobsSpawned(mobsSpawned)
+      , players()
+      , enemies()
+      , pickups()
     {}
   };
-private:  
-  Tile tiles[100][100];
+
+  using Members = std::vector<unsigned int> Room::*;
+
+  static constexpr unsigned int const CHUNK_SHIFT{6u};
+  static constexpr unsigned int const CHUNK_SIZE{1u << CHUNK_SHIFT};
+  static constexpr unsigned int const MAX_SIZE{4096u};
+  /**
+   * Must be bumped whenever generateLevel's output changes, so cached levels are regenerated.
+   */
+  static constexpr unsigned int const GENERATOR_VERSION{1u};
+  static constexpr unsigned int const DEFAULT_ROOM_COUNT{31u};
+  /**
+   * Room ids are stored on 16 bits.
+   */
+  static constexpr unsigned int const MAX_ROOM_COUNT{65535u};
+  /**
+   * From this many tiles, room ids are painted and the distance field baked on the worker pool given, if any.
+   */
+  static constexpr unsigned int const PARALLEL_TILES{1u << 20u};
+  /**
+   * Endless chunks: corridors to the 4 neighbours, CORRIDOR_WIDTH wide and at least LANE_MARGIN from the corners,
+   * meeting at a room carved somewhere inside.
+   */
+  static constexpr unsigned int const CORRIDOR_WIDTH{3u};
+  static constexpr unsigned int const LANE_MARGIN{8u};
+
+  /**
+   * One bit per tile for solidity (a row per uint64_t), room ids on 16 bits.
+   */
+  struct Chunk
+  {
+    std::array<std::uint64_t, CHUNK_SIZE> solid;
+    std::array<std::uint16_t, CHUNK_SIZE * CHUNK_SIZE> roomIds;
+
+    Chunk();
+  };
+
+private:
+  Vect<2u, unsigned int> size;
+  Vect<2u, unsigned int> chunkCount;
+  std::vector<std::unique_ptr<Chunk>> chunks;
+  std::vector<unsigned int> chunkRooms; // endless room carved in each chunk, 0 for none.
   std::vector<Room> rooms;
+  std::vector<unsigned int> freeRooms;
+  Vect<2u, long> origin;
   unsigned int seed;
+  DistanceField distanceField;
+  RoomGraph roomGraph;
 
-public:
+  friend class LevelCache;
 
-  Terrain();
+  /**
+   * Rectangle [begin, end[ of tiles painted with a room id, clipped to the terrain.
+   */
+  struct Stamp
+  {
+    Vect<2u, unsigned int> begin;
+    Vect<2u, unsigned int> end;
+    unsigned int roomId;
+  };
 
-  void generateLevel(unsigned int seed);
-  
-  Vect<2u, unsigned int> getSize() const;
-  
-  Room &getRoom(Vect<2u, unsigned int> pos);
+  Stamp clip(long beginX, long beginY, long endX, long endY, unsigned int roomId) const;
+
+  static constexpr std::uint64_t rowMask(unsigned int first, unsigned int last)
+  {
+    return (last - first == CHUNK_SIZE ? ~std::uint64_t(0u) : ((std::uint64_t(1u) << (last - first)) - 1u)) << first;
+  }
 
-  Tile const &getTile(Vect<2u, unsigned int> pos) const;
+  /**
+   * Calls func(chunk, row, first, last) for each chunk row the stamp covers between rowBegin and rowEnd,
+   * [first, last[ being the stamp's columns in that chunk.
+   */
+  template<class FUNC>
+  void forEachSpan(Stamp const &stamp, unsigned int rowBegin, unsigned int rowEnd, FUNC &&func) const
+  {
+    for (unsigned int y(std::max(stamp.begin[1], rowBegin)); y < std::min(stamp.end[1], rowEnd); ++y)
+      for (unsigned int x(stamp.begin[0]); x < stamp.end[0]; x = (x | (CHUNK_SIZE - 1u)) + 1u)
+	func((x >> CHUNK_SHIFT) + (y >> CHUNK_SHIFT) * chunkCount[0], y & (CHUNK_SIZE - 1u),
+	     x & (CHUNK_SIZE - 1u), std::min(stamp.end[0] - (x & ~(CHUNK_SIZE - 1u)), CHUNK_SIZE));
+  }
 
-  Tile &getTile(Vect<2u, unsigned int> pos);
+  bool isSolid(Stamp const &stamp) const;
+  void carve(Stamp const &stamp);
+  void paintRoomIds(Stamp const &stamp, unsigned int rowBegin, unsigned int rowEnd);
 
+  /**
+   * Deterministic value for a world chunk, salt telling apart the values drawn for one chunk.
+   */
+  std::uint64_t chunkHash(Vect<2u, long> world, unsigned int salt) const;
+
+  /**
+   * Row (axis 0) or column (axis 1), from the chunk's corner, of the corridor crossing
+   * the border between the world chunk and the next one along axis.
+   */
+  unsigned int laneOf(Vect<2u, long> world, unsigned int axis) const;
+
+  unsigned int allocateRoom(Vect<2u, double> pos);
+  void releaseRoom(unsigned int id);
+  void generateChunk(Vect<2u, unsigned int> chunk);
+
+  /**
+   * shiftWindow without the bakes, returns which chunks' distance field samples are stale.
+   */
+  std::vector<unsigned char> moveWindow(Vect<2u, int> delta);
+
+  Chunk const *getChunk(Vect<2u, unsigned int> pos) const
+  {
+    if (pos[0] >= size[0] || pos[1] >= size[1])
+      return nullptr;
+    return chunks[(pos[0] >> CHUNK_SHIFT) + (pos[1] >> CHUNK_SHIFT) * chunkCount[0]].get();
+  }
+
+  /**
+   * Moves the body along the sample's normal until it is radius away from the wall, if it is closer.
+   */
   template<class RESPONSE, class FIXTURE>
-  void correctFixture(FIXTURE &fixture, RESPONSE &&response)
+  static void pushOut(FIXTURE &fixture, DistanceField::Sample const &sample, RESPONSE &response)
   {
-    if (!fixture.doTerrainCollision())
+    double const distance(sample.distance + sample.normal.scalar(fixture.pos - sample.pos));
+
+    if (distance >= fixture.radius)
       return ;
-    Vect<2u, Vect<2u, double>> const extremes{(fixture.pos - Vect<2u, double>{fixture.radius, fixture.radius}),
-	(fixture.pos + Vect<2u, double>{fixture.radius, fixture.radius})};
-    Vect<2u, Vect<2u, unsigned>> const roundedExtremes(extremes);
-    Vect<2u, unsigned> const roundedCenter(fixture.pos);
+    fixture.pos += sample.normal * (fixture.radius - distance);
+    response(fixture, sample.normal);
+  }
 
-    { // Test sides. TODO: find a way to avoid code duplication without loosing clarity.
-      if (getTile({roundedExtremes[0][0], roundedCenter[1]}).isSolid)
-	{
-	  fixture.pos[0] = (roundedExtremes[0][0] + 1) + fixture.radius;
-	  response(fixture, Vect<2u, double>{1.0, 0.0});
-	}
-      else if (getTile({roundedExtremes[1][0], roundedCenter[1]}).isSolid)
-	{
-	  fixture.pos[0] = roundedExtremes[1][0] - fixture.radius;
-	  response(fixture, Vect<2u, double>{-1.0, 0.0});
-	}
-      if (getTile({roundedCenter[0], roundedExtremes[0][1]}).isSolid)
+  /**
+   * In a concave corner the sample's normal only knows one of the two walls.
+   * The body is in one when, on both axes, the closest side of its tile it leans to or touches is a wall.
+   * It is then moved off the faces of those walls it overlaps.
+   */
+  template<class RESPONSE, class FIXTURE>
+  void pushOutOfCorner(FIXTURE &fixture, RESPONSE &response) const
+  {
+    Vect<2u, int> const tile((int)std::floor(fixture.pos[0]), (int)std::floor(fixture.pos[1]));
+    Vect<2u, int> sides(0, 0); // toward the wall on each axis, 0 for none.
+    Vect<2u, double> gaps(std::max(fixture.radius, 0.5), std::max(fixture.radius, 0.5));
+
+    for (unsigned int i(0u); i != 2u; ++i)
+      for (int side : {-1, 1})
 	{
-	  fixture.pos[1] = (roundedExtremes[0][1] + 1) + fixture.radius;
-	  response(fixture, Vect<2u, double>{0.0, 1.0});
+	  Vect<2u, int> next(tile);
+	  double const gap(side > 0 ? tile[i] + 1.0 - fixture.pos[i] : fixture.pos[i] - tile[i]);
+
+	  next[i] += side;
+	  if (gap <= gaps[i] && isSolid({(unsigned int)next[0], (unsigned int)next[1]}))
+	    {
+	      sides[i] = side;
+	      gaps[i] = gap;
+	    }
 	}
-      else if (getTile({roundedCenter[0], roundedExtremes[1][1]}).isSolid)
+    if (!sides[0] || !sides[1])
+      return ;
+    for (unsigned int i(0u); i != 2u; ++i)
+      if (gaps[i] < fixture.radius)
 	{
-	  fixture.pos[1] = roundedExtremes[1][1] - fixture.radius;
-	  response(fixture, Vect<2u, double>{0.0, -1.0});
+	  Vect<2u, double> normal(0.0, 0.0);
+
+	  normal[i] = -sides[i];
+	  fixture.pos[i] -= sides[i] * (fixture.radius - gaps[i]);
+	  response(fixture, normal);
 	}
-    }
-    {
-      for (unsigned int k : {0, 1})
-	for (unsigned int j : {0, 1})
+  }
+
+public:
+
+  Terrain(Vect<2u, unsigned int> size = {100u, 100u});
+  Terrain(Terrain const &) = delete;
+  Terrain(Terrain &&) = default;
+  Terrain &operator=(Terrain &&) = default;
+
+  /**
+   * Drops every tile. Each side must not exceed MAX_SIZE.
+   */
+  void resize(Vect<2u, unsigned int> size);
+
+  /**
+   * Rooms and corridors are carved in order, a later one overwriting the room ids of earlier ones.
+   * A room is linked to the center by a corridor when none of its tiles were carved before it.
+   * roomCount counts the start and end rooms, so it must be between 2 and MAX_ROOM_COUNT.
+   */
+  void generateLevel(unsigned int seed, unsigned int roomCount = DEFAULT_ROOM_COUNT, WorkerPool *pool = nullptr);
+
+  /**
+   * Endless mode: the terrain is a window over an unbounded world, whose chunks are generated
+   * from the seed and their world position alone, so a chunk is the same every time it is generated.
+   * Every chunk of the window, starting at the origin world chunk, is generated.
+   */
+  void startEndless(unsigned int seed, Vect<2u, unsigned int> windowChunks, Vect<2u, long> origin = {0l, 0l},
+		    WorkerPool *pool = nullptr);
+
+  /**
+   * Moves the window by delta chunks. Chunks leaving it are dropped with their rooms, whose ids are reused,
+   * entering ones are generated. Rooms keep their ids, their positions follow the window.
+   * Entities are left to the caller.
+   */
+  void shiftWindow(Vect<2u, int> delta);
+
+  /**
+   * Same as shiftWindow, toward next's origin, but the distance field and room graph are taken from next
+   * instead of being baked: next must be an endless terrain of the same seed and window size.
+   * Both only depend on the tiles' solidity and on which tiles share a room, so they are the ones
+   * shiftWindow would bake, and next can be started ahead of time on another thread.
+   */
+  void shiftWindow(Terrain &&next);
+
+  /**
+   * World chunk of the window's first chunk, zero out of endless mode.
+   */
+  Vect<2u, long> getOrigin() const;
+  unsigned int getSeed() const;
+
+  /**
+   * Room carved in an endless chunk, 0 for none.
+   */
+  unsigned int getChunkRoom(Vect<2u, unsigned int> chunk) const;
+
+  Vect<2u, unsigned int> getSize() const;
+  Vect<2u, unsigned int> getChunkCount() const;
+  bool hasChunk(Vect<2u, unsigned int> chunk) const;
+
+  /**
+   * Must be called after changing tiles, generateLevel does it.
+   */
+  void bakeDistanceField(WorkerPool *pool = nullptr);
+  DistanceField const &getDistanceField() const;
+
+  Room &getRoom(Vect<2u, unsigned int> pos);
+  std::vector<Room> &getRooms();
+  std::vector<Room> const &getRooms() const;
+
+  /**
+   * Moves the elements from first on whose room changed to their new room's list.
+   * Each element remembers its listed room in roomId, new elements are added.
+   * Indexes must not have shifted since the last call, use rebuildMembers after removals.
+   */
+  template<class CONTAINER>
+  void updateMembers(CONTAINER &container, Members members, unsigned int first = 0u)
+  {
+    for (unsigned int i(first); i < container.size(); ++i)
+      {
+	unsigned int const roomId(getRoomId(Vect<2u, unsigned int>(container[i].pos)));
+
+	if (roomId == container[i].roomId)
+	  continue ;
+	if (container[i].roomId < rooms.size())
 	  {
-	    Vect<2u, unsigned> i{};
-
-	    for (i[1] = roundedExtremes[k][1]; i[1] != roundedCenter[1]; i[1] += (1 - 2 * k))
-	      for (i[0] = roundedExtremes[j][0]; i[0] != roundedCenter[0]; i[0] += (1 - 2 * j))
-		{
-		  Vect<2u, double> const corner(i + Vect<2, unsigned>{1 - j, 1 - k});
-		  Vect<2u, double> const diff(fixture.pos - corner);
-		  Vect<2u, double> const normalizedDiff(diff.normalized());
-
-		  if (diff.length2() < fixture.radius * fixture.radius && getTile(i).isSolid)
-		    {
-		      fixture.pos = corner + normalizedDiff * fixture.radius;
-		      response(fixture, -normalizedDiff);
-		    }
-		}
+	    std::vector<unsigned int> &list(rooms[container[i].roomId].*members);
+	    auto const member(std::find(list.begin(), list.end(), i));
+
+	    // Missing when the list was rebuilt without it, there is then nothing to remove.
+	    if (member != list.end())
+	      {
+		*member = list.back();
+		list.pop_back();
+	      }
 	  }
-    }
+	container[i].roomId = roomId;
+	if (roomId < rooms.size())
+	  (rooms[roomId].*members).push_back(i);
+      }
   }
 
+  template<class CONTAINER>
+  void rebuildMembers(CONTAINER &container, Members members)
+  {
+    for (Room &room : rooms)
+      (room.*members).clear();
+    for (auto &element : container)
+      element.roomId = ~0u;
+    updateMembers(container, members);
+  }
+
+  /**
+   * Built by generateLevel.
+   */
+  RoomGraph &getRoomGraph();
+
+  bool isSolid(Vect<2u, unsigned int> pos) const
+  {
+    Chunk const *chunk(getChunk(pos));
+
+    return !chunk || ((chunk->solid[pos[1] & (CHUNK_SIZE - 1u)] >> (pos[0] & (CHUNK_SIZE - 1u))) & 1u);
+  }
+
+  unsigned int getRoomId(Vect<2u, unsigned int> pos) const
+  {
+    Chunk const *chunk(getChunk(pos));
+
+    return chunk ? chunk->roomIds[(pos[0] & (CHUNK_SIZE - 1u)) + (pos[1] & (CHUNK_SIZE - 1u)) * CHUNK_SIZE] : 0u;
+  }
+
+  /**
+   * Solidity of the CHUNK_SIZE tiles from (x, y) on, one bit each, x being a multiple of CHUNK_SIZE.
+   */
+  std::uint64_t getSolidRow(long x, long y) const
+  {
+    Chunk const *chunk(x < 0 || y < 0 ? nullptr : getChunk({(unsigned int)x, (unsigned int)y}));
+
+    return chunk ? chunk->solid[(unsigned int)y & (CHUNK_SIZE - 1u)] : ~std::uint64_t(0u);
+  }
+
+  Tile getTile(Vect<2u, unsigned int> pos) const;
+
+  /**
+   * Grid DDA over every segment of the batch.
+   * Setup is done for all rays in one pass, then each ray walks the grid.
+   */
+  void raycast(RayBatch &batch) const;
+
+  bool lineOfSight(Vect<2u, double> start, Vect<2u, double> end) const;
+
+  /**
+   * Writes out of the terrain are ignored.
+   */
+  void setTile(Vect<2u, unsigned int> pos, Tile tile);
+
+  /**
+   * One distance field lookup per body, the distance being carried from the sample to the body along the normal.
+   * Bodies closer to a wall than their radius are pushed out along the normal in one step.
+   * Only near walls, concave corners are then checked with the tiles along both axes, see pushOutOfCorner.
+   */
+  template<class RESPONSE, class FIXTURE>
+  void correctFixture(FIXTURE &fixture, RESPONSE &&response)
+  {
+    if (!fixture.doTerrainCollision())
+      return ;
+
+    DistanceField::Sample const sample(distanceField.sample(fixture.pos));
+
+    if (sample.distance >= fixture.radius + DistanceField::SAMPLE_REACH || sample.normal.equals({0.0, 0.0}))
+      return ;
+    pushOut(fixture, sample, response);
+    pushOutOfCorner(fixture, response);
+  }
 
   template<class FIXTURE>
   void correctFixture(FIXTURE &fixture)
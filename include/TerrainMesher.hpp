@@ -0,0 +1,77 @@
+#ifndef TERRAIN_MESHER_HPP
+# define TERRAIN_MESHER_HPP
+
+# include <vector>
+# include <cstdint>
+# include "Vect.hpp"
+
+class Terrain;
+
+/**
+ * Builds the render geometry of terrain chunks from their solidity.
+ * Wall sides are only emitted against floor tiles, and merged along each wall's run.
+ * Wall tops, and floors of each room, are merged greedily into rectangles.
+ * Positions are relative to the chunk's corner, in tiles, y up; texture coordinates repeat once per tile.
+ */
+class TerrainMesher
+{
+public:
+  static constexpr float const WALL_HEIGHT{2.0f};
+
+  struct Vertex
+  {
+    float pos[3];
+    float normal[3];
+    float uv[2];
+  };
+
+  struct Mesh
+  {
+    std::vector<Vertex> vertices;
+    std::vector<std::uint32_t> indices;
+
+    std::size_t getTriangleCount() const;
+  };
+
+  /**
+   * Walls cast shadows, floors don't.
+   */
+  struct ChunkMesh
+  {
+    Mesh walls;
+    Mesh floors;
+  };
+
+  /**
+   * Triangles of the whole terrain, with one mesh per tile (4 sides and a top per wall, a quad per floor)
+   * and once meshed.
+   */
+  struct Report
+  {
+    std::size_t tileTriangles;
+    std::size_t wallTriangles;
+    std::size_t floorTriangles;
+  };
+
+private:
+  static void addSide(Mesh &mesh, Vect<3u, float> start, Vect<3u, float> right, float length);
+  static void addFlat(Mesh &mesh, Vect<2u, float> begin, Vect<2u, float> end, float height);
+
+  /**
+   * Covers the tiles of the chunk matching kind with rectangles, calling addRect(begin, end) for each.
+   * kind(tile) returns the kind of a tile, tiles of kind 0 are not covered, a rectangle holds one kind.
+   */
+  template<class KIND, class ADD_RECT>
+  static void greedyRects(Vect<2u, unsigned int> size, KIND &&kind, ADD_RECT &&addRect);
+
+public:
+  static ChunkMesh meshChunk(Terrain const &terrain, Vect<2u, unsigned int> chunk);
+
+  /**
+   * Meshes of every chunk, row by row.
+   */
+  static std::vector<ChunkMesh> meshTerrain(Terrain const &terrain);
+  static Report report(Terrain const &terrain);
+};
+
+#endif
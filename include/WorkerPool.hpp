@@ -0,0 +1,46 @@
+#ifndef WORKER_POOL_HPP
+# define WORKER_POOL_HPP
+
+# include <mutex>
+# include <thread>
+# include <vector>
+# include <functional>
+# include <condition_variable>
+
+/**
+ * Threads kept alive for the whole level, woken up for each job.
+ * The calling thread takes part in the job as worker 0.
+ */
+class WorkerPool
+{
+private:
+  std::vector<std::thread> threads;
+  std::mutex running; // held by run, so callers on several threads take turns.
+  std::mutex lock;
+  std::condition_variable wake;
+  std::condition_variable done;
+  std::function<void(unsigned int)> job;
+  unsigned int generation;
+  unsigned int pending;
+  bool stop;
+
+  void work(unsigned int worker);
+
+public:
+  WorkerPool(unsigned int size = std::thread::hardware_concurrency());
+  WorkerPool(WorkerPool const &) = delete;
+  ~WorkerPool();
+
+  /**
+   * Number of workers, including the calling thread.
+   */
+  unsigned int getSize() const;
+
+  /**
+   * Calls job(worker) once for each worker, returns once all are done.
+   * Waits for the job of another thread to finish first.
+   */
+  void run(std::function<void(unsigned int)> const &job);
+};
+
+#endif
@@ -0,0 +1,61 @@
+#version 120
+
+// Hardware instancing: each instance's world matrix comes as three rows,
+// in the texture coordinates following the mesh's own.
+// Lighting is per vertex, like the fixed function pipeline the other materials use.
+
+attribute vec4 vertex;
+attribute vec3 normal;
+#ifdef TEXTURED
+attribute vec2 uv0;
+attribute vec4 uv1;
+attribute vec4 uv2;
+attribute vec4 uv3;
+# define ROW0 uv1
+# define ROW1 uv2
+# define ROW2 uv3
+#else
+attribute vec4 uv0;
+attribute vec4 uv1;
+attribute vec4 uv2;
+# define ROW0 uv0
+# define ROW1 uv1
+# define ROW2 uv2
+#endif
+
+#define LIGHT_COUNT 4
+
+uniform mat4 viewProjMatrix;
+uniform vec4 ambientLight;
+uniform vec4 surfaceAmbient;
+uniform vec4 surfaceDiffuse;
+uniform vec4 surfaceEmissive;
+uniform vec4 lightPosition[LIGHT_COUNT];
+uniform vec4 lightDiffuse[LIGHT_COUNT];
+uniform vec4 lightAttenuation[LIGHT_COUNT];
+
+void main()
+{
+  mat4 worldMatrix = mat4(ROW0, ROW1, ROW2, vec4(0.0, 0.0, 0.0, 1.0));
+  vec4 worldPos = vertex * worldMatrix;
+  vec3 worldNormal = normalize(normal * mat3(worldMatrix));
+  vec3 colour = ambientLight.rgb * surfaceAmbient.rgb + surfaceEmissive.rgb;
+
+  for (int i = 0; i < LIGHT_COUNT; ++i)
+    {
+      // w is 0 for directional lights, whose position is their direction.
+      vec3 toLight = lightPosition[i].xyz - worldPos.xyz * lightPosition[i].w;
+      float distance = max(length(toLight), 0.0001);
+      float attenuation = 1.0;
+
+      if (lightPosition[i].w != 0.0)
+	attenuation = distance > lightAttenuation[i].x ? 0.0 :
+	  1.0 / (lightAttenuation[i].y + lightAttenuation[i].z * distance + lightAttenuation[i].w * distance * distance);
+      colour += surfaceDiffuse.rgb * lightDiffuse[i].rgb * max(dot(worldNormal, toLight / distance), 0.0) * attenuation;
+    }
+  gl_FrontColor = vec4(colour, surfaceDiffuse.a);
+#ifdef TEXTURED
+  gl_TexCoord[0] = gl_TextureMatrix[0] * vec4(uv0, 0.0, 1.0);
+#endif
+  gl_Position = viewProjMatrix * worldPos;
+}
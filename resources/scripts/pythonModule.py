@@ -33,12 +33,12 @@ def fleeFromVec(entity, vec, evaluater, speed):
 def stand(entity):
 	entity.setInput(PyPlugin.Vect(0.0, 0.0))
 
-def shootAtVec(entity, vec, evaluater, speedChase, speedFlee, minRange, maxRange):
+def shootAtVec(entity, vec, evaluater, speedChase, speedFlee, minRange, maxRange, visible=True):
     dist = subVec(vec, entity.pos).length2()
     direc = subVec(vec, entity.pos).normalized()
     if (dist < minRange):
         fleeFromVec(entity, vec, evaluater, speedFlee)
-    elif (dist >= minRange and dist <= maxRange):
+    elif (dist >= minRange and dist <= maxRange and visible):
     	entity.setDir(direc)
     else:
         chaseVec(entity, vec, evaluater, speedChase)
@@ -47,17 +47,36 @@ def followRightWall(entity, evaluater, speed):
     vec = evaluater.followRightWall(entity.pos)
     moveEntityFromVec(entity, vec, speed)
 
+def closestEnemyNear(entity, evaluater):
+    if (evaluater.enemiesInRoom(entity.pos) > 0):
+        return evaluater.closestEnemyInRoom(entity.pos)
+    return evaluater.closestEnemy(entity.pos)
+
+def followPath(entity, vec, evaluater, speed):
+    direc = evaluater.pathTowards(entity.pos, vec)
+    if (direc.equals(PyPlugin.Vect(0.0, 0.0))):
+        followRightWall(entity, evaluater, speed)
+    else:
+        entity.setInput(mulVec(direc, speed))
+
 class pythonModule():
     def __init__(self):
         self.heroSpeed = 0.03
 
     def chasePlayerAI(self, entity, evaluater):
         evaluater.attack = False
-        vec = evaluater.closestPlayer(entity.pos)
-        chaseVec(entity, vec, evaluater, 0.01)
+        direc = evaluater.flowDirection(entity.pos)
+        if (direc.equals(PyPlugin.Vect(0.0, 0.0))):
+            vec = evaluater.closestPlayer(entity.pos)
+            chaseVec(entity, vec, evaluater, 0.01)
+        else:
+            entity.setInput(mulVec(direc, 0.01))
 
     def fleePlayerAI(self, entity, evaluater):
         evaluater.attack = False
+        if (evaluater.playersInRoom(entity.pos) == 0):
+            stand(entity)
+            return
         vec = evaluater.closestPlayer(entity.pos)
         fleeFromVec(entity, vec, evaluater, 0.015)
 
@@ -77,8 +96,14 @@ class pythonModule():
 
     def shootPlayerAI(self, entity, evaluater):
         evaluater.attack = False
+        if (evaluater.projectileDanger(entity.pos) >= 1.0):
+            safe = evaluater.safestCell(entity.pos)
+            if (not safe.equals(entity.pos)):
+                chaseVec(entity, safe, evaluater, 0.02)
+                return
         vec = evaluater.closestPlayer(entity.pos)
-        shootAtVec(entity, vec, evaluater, 0.02, 0.04, 60, 80)
+        visible = evaluater.seesClosestPlayer(entity)
+        shootAtVec(entity, vec, evaluater, 0.02, 0.04, 60, 80, visible)
 
     def shootEnemyAI(self, entity, evaluater):
         evaluater.attack = False
@@ -91,21 +116,30 @@ class pythonModule():
 
     def leaderContactAI(self, entity, evaluater):
         evaluater.attack = False
-        vec = evaluater.closestEnemy(entity.pos)
+        vec = closestEnemyNear(entity, evaluater)
         if (vec.equals(entity.pos)):
-            followRightWall(entity, evaluater, self.heroSpeed)
+            pickup = evaluater.closestPickupInRoom(entity.pos)
+            if (pickup.equals(entity.pos)):
+                followRightWall(entity, evaluater, self.heroSpeed)
+            else:
+                chaseVec(entity, pickup, evaluater, self.heroSpeed)
         else:
             chaseVec(entity, vec, evaluater, self.heroSpeed)
             evaluater.attack = True
 
     def leaderDistanceAI(self, entity, evaluater):
         evaluater.attack = False
-        vec = evaluater.closestEnemy(entity.pos)
+        vec = closestEnemyNear(entity, evaluater)
         if (vec.equals(entity.pos)):
-            followRightWall(entity, evaluater, self.heroSpeed)
+            pickup = evaluater.closestPickupInRoom(entity.pos)
+            if (pickup.equals(entity.pos)):
+                followRightWall(entity, evaluater, self.heroSpeed)
+            else:
+                chaseVec(entity, pickup, evaluater, self.heroSpeed)
         else:
-            shootAtVec(entity, vec, evaluater, self.heroSpeed, self.heroSpeed, 30, 60)
-            evaluater.attack = True
+            visible = evaluater.lineOfSight(entity.pos, vec)
+            shootAtVec(entity, vec, evaluater, self.heroSpeed, self.heroSpeed, 30, 60, visible)
+            evaluater.attack = visible
 
     def companionContactAI(self, entity, evaluater):
         evaluater.attack = False
@@ -118,6 +152,8 @@ class pythonModule():
             evaluater.attack = True
         elif (distLeader.length2() > 1 and distLeader.length2() < 100):
             chaseVec(entity, leader, evaluater, self.heroSpeed)
+        elif (distLeader.length2() >= 100):
+            followPath(entity, leader, evaluater, self.heroSpeed)
         else:
             followRightWall(entity, evaluater, self.heroSpeed)
 
@@ -128,9 +164,12 @@ class pythonModule():
         distLeader = subVec(entity.pos, leader)
         distEnemy = subVec(entity.pos, enemy)
         if (distEnemy.length2() > 1 and distEnemy.length2() < 100):
-            shootAtVec(entity, enemy, evaluater, self.heroSpeed, self.heroSpeed, 30, 60)
-            evaluater.attack = True
+            visible = evaluater.lineOfSight(entity.pos, enemy)
+            shootAtVec(entity, enemy, evaluater, self.heroSpeed, self.heroSpeed, 30, 60, visible)
+            evaluater.attack = visible
         elif (distLeader.length2() > 1 and distLeader.length2() < 100):
             chaseVec(entity, leader, evaluater, self.heroSpeed)
+        elif (distLeader.length2() >= 100):
+            followPath(entity, leader, evaluater, self.heroSpeed)
         else:
             followRightWall(entity, evaluater, self.heroSpeed)
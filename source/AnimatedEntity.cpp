@@ -1,5 +1,24 @@
+#include <stdexcept>
 #include "AnimatedEntity.hpp"
 
+AnimatedEntity::AnimationTable AnimatedEntity::resolveAnimations(Ogre::Entity &ogreEntity)
+{
+  AnimationTable animations;
+
+  for (unsigned int i(0u); i != animations.size(); ++i)
+    animations[i] = ogreEntity.hasAnimationState(Animations::NAMES[i]) ? ogreEntity.getAnimationState(Animations::NAMES[i]) : nullptr;
+  return animations;
+}
+
+Ogre::AnimationState *AnimatedEntity::getAnimation(Animations::Id id)
+{
+  Ogre::AnimationState *animation(animations[(unsigned int)id]);
+
+  if (!animation)
+    throw std::invalid_argument(std::string("AnimatedEntity: the mesh has no animation ") + Animations::NAMES[(unsigned int)id]);
+  return animation;
+}
+
 Entity &AnimatedEntity::getEntity(void)
 {
   return (entity);
@@ -10,9 +29,9 @@ Entity const &AnimatedEntity::getEntity(void) const
   return (entity);
 }
 
-void AnimatedEntity::setMainAnimation(std::string const &s, Ogre::Real timer, bool loop)
+void AnimatedEntity::setMainAnimation(Animations::Id id, Ogre::Real timer, bool loop)
 {
-  Ogre::AnimationState *target = entity.getOgre()->getAnimationState(s);
+  Ogre::AnimationState *target = getAnimation(id);
 
   if (blendTimer <= 0 && targetMainAnimation != target)
   {
@@ -32,9 +51,9 @@ void AnimatedEntity::setMainAnimation(std::string const &s, Ogre::Real timer, bo
   }
 }
 
-void AnimatedEntity::addSubAnimation(std::string const &s, bool reset, bool loop)
+void AnimatedEntity::addSubAnimation(Animations::Id id, bool reset, bool loop)
 {
-  Ogre::AnimationState *as(entity.getOgre()->getAnimationState(s));
+  Ogre::AnimationState *as(getAnimation(id));
 
   as->setLoop(loop);
   as->setWeight(as->getWeight() * !reset + 0.10f * reset);
@@ -64,15 +83,18 @@ void AnimatedEntity::updateAnimations(Ogre::Real r)
       targetMainAnimation->setWeight(1.f - blendTimer / blendDuration);
     }
   }
-  for (auto &anim : entity.getOgre()->getAllAnimationStates()->getAnimationStateIterator()) {
-    anim.second->addTime(r);
-    if (anim.second != mainAnimation && anim.second != targetMainAnimation)
+  // Only resolved animations are ever enabled.
+  for (Ogre::AnimationState *anim : animations) {
+    if (!anim)
+      continue ;
+    anim->addTime(r);
+    if (anim != mainAnimation && anim != targetMainAnimation)
     {
-      if (anim.second->getTimePosition() >= anim.second->getLength() && anim.second->getWeight() > 0.01f)
-        anim.second->setWeight(anim.second->getWeight() / 1.5f);
-      else if (anim.second->getTimePosition() < anim.second->getLength() && anim.second->getWeight() < 1.f)
-        anim.second->setWeight(anim.second->getWeight() * 1.5f);
-      anim.second->setEnabled(anim.second->getEnabled() * (anim.second->getWeight() > 0.01));
+      if (anim->getTimePosition() >= anim->getLength() && anim->getWeight() > 0.01f)
+        anim->setWeight(anim->getWeight() / 1.5f);
+      else if (anim->getTimePosition() < anim->getLength() && anim->getWeight() < 1.f)
+        anim->setWeight(anim->getWeight() * 1.5f);
+      anim->setEnabled(anim->getEnabled() * (anim->getWeight() > 0.01));
     }
   }
 }
@@ -0,0 +1,159 @@
+#include <cmath>
+#include "Broadphase.hpp"
+#include "Physics.hpp"
+
+constexpr unsigned int const Broadphase::PARALLEL_THRESHOLD;
+constexpr unsigned int const Broadphase::MAX_GRID_CELLS;
+
+Broadphase::Broadphase(double cellSize)
+  : proxies()
+  , order()
+  , cellSize(cellSize)
+  , gridOrigin{0.0, 0.0}
+  , gridSize{0u, 0u}
+  , cellStart()
+  , cellEntries()
+  , buckets()
+  , workerPairs()
+{
+}
+
+void Broadphase::clear()
+{
+  proxies.clear();
+}
+
+void Broadphase::insert(Vect<2u, double> pos, double radius,
+			unsigned int category, unsigned int mask, unsigned int item)
+{
+  if (!std::isfinite(pos[0]) || !std::isfinite(pos[1]) || !std::isfinite(radius))
+    return ;
+  proxies.push_back(Proxy{pos, radius, (unsigned int)proxies.size(), category, mask, item});
+}
+
+std::vector<Broadphase::Proxy> const &Broadphase::getProxies() const
+{
+  return proxies;
+}
+
+void Broadphase::narrowphase(Proxy const &a, Proxy const &b, std::vector<std::pair<unsigned int, unsigned int>> &pairs) const
+{
+  if (a.collidesWith(b) && Physics::circleTest(a.pos, a.radius, b.pos, b.radius))
+    pairs.emplace_back(a.index, b.index);
+}
+
+void Broadphase::fillBuckets()
+{
+  for (auto &bucket : buckets)
+    bucket.clear();
+  for (auto const &pairs : workerPairs)
+    for (auto const &pair : pairs)
+      {
+	Proxy const &a(proxies[pair.first]);
+	Proxy const &b(proxies[pair.second]);
+
+	// Both ways, so either category can lead the responses.
+	buckets[a.category * Collision::CATEGORY_COUNT + b.category].emplace_back(a.item, b.item);
+	if (a.category != b.category)
+	  buckets[b.category * Collision::CATEGORY_COUNT + a.category].emplace_back(b.item, a.item);
+      }
+  for (auto &bucket : buckets)
+    std::sort(bucket.begin(), bucket.end());
+}
+
+void Broadphase::collectPairs(Strategy strategy)
+{
+  workerPairs.resize(1u);
+  workerPairs[0].clear();
+  findPairs(strategy, [this](Proxy const &a, Proxy const &b)
+	    {
+	      narrowphase(a, b, workerPairs[0]);
+	    });
+  fillBuckets();
+}
+
+void Broadphase::collectPairs(WorkerPool &pool)
+{
+  if (proxies.size() < PARALLEL_THRESHOLD || pool.getSize() == 1u)
+    {
+      collectPairs(Strategy::UNIFORM_GRID);
+      return ;
+    }
+  if (!buildGrid())
+    {
+      collectPairs(Strategy::SORT_AND_SWEEP);
+      return ;
+    }
+  workerPairs.resize(pool.getSize());
+  pool.run([this, &pool](unsigned int worker)
+	   {
+	     unsigned int const cellCount((unsigned int)cellStart.size() - 1u);
+
+	     workerPairs[worker].clear();
+	     gridCells(cellCount * worker / pool.getSize(), cellCount * (worker + 1u) / pool.getSize(),
+		       [this, worker](Proxy const &a, Proxy const &b)
+		       {
+			 narrowphase(a, b, workerPairs[worker]);
+		       });
+	   });
+  fillBuckets();
+}
+
+std::vector<std::pair<unsigned int, unsigned int>> const &Broadphase::getPairs(unsigned int categoryA, unsigned int categoryB) const
+{
+  return buckets[categoryA * Collision::CATEGORY_COUNT + categoryB];
+}
+
+bool Broadphase::buildGrid()
+{
+  Vect<2u, double> min{0.0, 0.0};
+  Vect<2u, double> max{0.0, 0.0};
+
+  if (!proxies.empty())
+    {
+      min = proxies.front().pos;
+      max = proxies.front().pos;
+    }
+  for (Proxy const &proxy : proxies)
+    for (unsigned int i(0u); i != 2u; ++i)
+      {
+	min[i] = std::min(min[i], proxy.pos[i] - proxy.radius);
+	max[i] = std::max(max[i], proxy.pos[i] + proxy.radius);
+      }
+  // Sized in double first, far away bodies would overflow the cell count.
+  Vect<2u, double> const cells(std::floor((max[0] - min[0]) / cellSize) + 1.0,
+			       std::floor((max[1] - min[1]) / cellSize) + 1.0);
+
+  if (cells[0] * cells[1] > MAX_GRID_CELLS)
+    return false;
+  gridOrigin = min;
+  gridSize = {(unsigned int)cells[0], (unsigned int)cells[1]};
+
+  auto const forEachCell([this](Proxy const &proxy, auto &&func)
+			 {
+			   Vect<2u, unsigned int> const begin(cellOf(proxy.pos - Vect<2u, double>{proxy.radius, proxy.radius}));
+			   Vect<2u, unsigned int> const end(cellOf(proxy.pos + Vect<2u, double>{proxy.radius, proxy.radius}));
+
+			   for (unsigned int y(begin[1]); y <= end[1]; ++y)
+			     for (unsigned int x(begin[0]); x <= end[0]; ++x)
+			       func(x + y * gridSize[0]);
+			 });
+
+  // Counting sort of the proxies by cell.
+  cellStart.assign(gridSize[0] * gridSize[1] + 1u, 0u);
+  for (Proxy const &proxy : proxies)
+    forEachCell(proxy, [this](unsigned int cell)
+		{
+		  ++cellStart[cell + 1];
+		});
+  for (unsigned int cell(1u); cell != cellStart.size(); ++cell)
+    cellStart[cell] += cellStart[cell - 1];
+  cellEntries.resize(cellStart.back());
+  order.assign(cellStart.begin(), cellStart.end() - 1);
+  for (Proxy const &proxy : proxies)
+    forEachCell(proxy, [this, &proxy](unsigned int cell)
+		{
+		  cellEntries[order[cell]++] = proxy.index;
+		});
+  return true;
+}
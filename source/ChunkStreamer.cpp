@@ -0,0 +1,110 @@
+#include <cmath>
+#include <algorithm>
+#include "ChunkStreamer.hpp"
+
+constexpr unsigned int const ChunkStreamer::WINDOW_CHUNKS;
+constexpr unsigned int const ChunkStreamer::MARGIN;
+constexpr unsigned int const ChunkStreamer::MAX_ARCHIVED;
+constexpr unsigned int const ChunkStreamer::POSITION_SCALE;
+
+ChunkStreamer::ChunkStreamer()
+  : archives()
+  , order()
+  , stamp(0u)
+{
+}
+
+bool ChunkStreamer::entered(Terrain const &terrain, Vect<2u, int> delta, Vect<2u, unsigned int> chunk)
+{
+  for (unsigned int i(0u); i != 2u; ++i)
+    {
+      long const before((long)chunk[i] + delta[i]);
+
+      if (before < 0l || before >= (long)terrain.getChunkCount()[i])
+	return true;
+    }
+  return false;
+}
+
+Vect<2u, int> ChunkStreamer::windowShift(Terrain const &terrain, std::vector<Player> const &players)
+{
+  Vect<2u, int> delta(0, 0);
+
+  if (players.empty())
+    return delta;
+
+  Vect<2u, double> center(0.0, 0.0);
+
+  for (Player const &player : players)
+    center += player.pos;
+  center /= (double)players.size();
+  for (unsigned int i(0u); i != 2u; ++i)
+    {
+      int const count((int)terrain.getChunkCount()[i]);
+      int const chunk((int)std::floor(center[i] / Terrain::CHUNK_SIZE));
+
+      if (chunk < (int)MARGIN || chunk >= count - (int)MARGIN)
+	delta[i] = chunk - count / 2;
+    }
+  return delta;
+}
+
+bool ChunkStreamer::leaves(Terrain const &terrain, Vect<2u, int> delta, Vect<2u, double> pos)
+{
+  for (unsigned int i(0u); i != 2u; ++i)
+    {
+      double const after(pos[i] - (double)delta[i] * Terrain::CHUNK_SIZE);
+
+      if (!(after >= 0.0 && after < (double)terrain.getSize()[i]))
+	return true;
+    }
+  return false;
+}
+
+void ChunkStreamer::archive(Terrain const &terrain, Vect<2u, int> delta, std::vector<Enemy> const &enemies)
+{
+  std::vector<Archive *> leaving(terrain.getChunkCount()[0] * terrain.getChunkCount()[1], nullptr);
+  auto const open([this, &terrain, &leaving](Vect<2u, unsigned int> chunk)
+		  {
+		    Archive *&archive(leaving[chunk[0] + chunk[1] * terrain.getChunkCount()[0]]);
+
+		    if (!archive)
+		      {
+			unsigned long long const chunkKey(key(terrain.getOrigin() + Vect<2u, long>(chunk)));
+
+			archive = &archives[chunkKey];
+			archive->stamp = ++stamp;
+			archive->enemies.clear();
+			order.emplace_back(chunkKey, stamp);
+		      }
+		    return archive;
+		  });
+
+  for (Vect<2u, unsigned int> chunk(0u, 0u); chunk[1] != terrain.getChunkCount()[1]; ++chunk[1])
+    for (chunk[0] = 0u; chunk[0] != terrain.getChunkCount()[0]; ++chunk[0])
+      if (leaves(terrain, delta, Vect<2u, double>(chunk * Terrain::CHUNK_SIZE))
+	  && terrain.getChunkRoom(chunk) && terrain.getRooms()[terrain.getChunkRoom(chunk)].mobsSpawned)
+	open(chunk);
+  for (Enemy const &enemy : enemies)
+    {
+      if (enemy.isDead() || !leaves(terrain, delta, enemy.pos)
+	  || !(enemy.pos[0] >= 0.0 && enemy.pos[1] >= 0.0 && enemy.pos[0] < terrain.getSize()[0] && enemy.pos[1] < terrain.getSize()[1]))
+	continue ;
+
+      Vect<2u, unsigned int> const chunk((unsigned int)enemy.pos[0] / Terrain::CHUNK_SIZE, (unsigned int)enemy.pos[1] / Terrain::CHUNK_SIZE);
+      Vect<2u, double> const local(enemy.pos - Vect<2u, double>(chunk * Terrain::CHUNK_SIZE));
+
+      open(chunk)->enemies.push_back(PackedEnemy{{(std::uint16_t)(local[0] * POSITION_SCALE), (std::uint16_t)(local[1] * POSITION_SCALE)},
+	    (std::uint16_t)std::min(enemy.getHealth(), 0xFFFF), (std::uint16_t)std::min(enemy.getMaxHealth(), 0xFFFF),
+	      (std::uint16_t)enemy.ai});
+    }
+  // Restored archives leave stale entries in order, it is bounded as well.
+  while (archives.size() > MAX_ARCHIVED || order.size() > 2u * MAX_ARCHIVED)
+    {
+      auto const archive(archives.find(order.front().first));
+
+      if (archive != archives.end() && archive->second.stamp == order.front().second)
+	archives.erase(archive);
+      order.pop_front();
+    }
+}
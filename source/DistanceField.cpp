@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <utility>
+#include "DistanceField.hpp"
+#include "Terrain.hpp"
+#include "MappedFile.hpp"
+#include "WorkerPool.hpp"
+
+constexpr unsigned int const DistanceField::RESOLUTION;
+constexpr double const DistanceField::MAX_DISTANCE;
+constexpr double const DistanceField::DISTANCE_SCALE;
+constexpr double const DistanceField::NORMAL_SCALE;
+constexpr double const DistanceField::SAMPLE_REACH;
+constexpr int const DistanceField::REACH;
+constexpr unsigned int const DistanceField::WINDOW_SIDE;
+constexpr std::uint32_t const DistanceField::WINDOW_MASK;
+
+DistanceField::DistanceField()
+  : chunkSamples(Terrain::CHUNK_SIZE * RESOLUTION)
+  , chunkCount{0u, 0u}
+  , chunks()
+  , samples()
+  , mapping()
+{
+}
+
+void DistanceField::bake(Terrain const &terrain, WorkerPool *pool)
+{
+  chunkCount = terrain.getChunkCount();
+  chunks.clear();
+  chunks.resize(chunkCount[0] * chunkCount[1]);
+  samples.assign(chunks.size(), nullptr);
+  mapping.reset();
+
+  std::vector<Vect<2u, unsigned int>> allocated;
+
+  for (Vect<2u, unsigned int> chunk(0u, 0u); chunk[1] != chunkCount[1]; ++chunk[1])
+    for (chunk[0] = 0u; chunk[0] != chunkCount[0]; ++chunk[0])
+      if (terrain.hasChunk(chunk))
+	allocated.push_back(chunk);
+
+  auto const bakeRange([this, &terrain, &allocated](std::size_t begin, std::size_t end)
+		       {
+			 for (std::size_t i(begin); i != end; ++i)
+			   bakeChunk(terrain, allocated[i]);
+		       });
+
+  if (!pool || terrain.getSize()[0] * terrain.getSize()[1] < Terrain::PARALLEL_TILES)
+    bakeRange(0u, allocated.size());
+  else
+    // Chunks are independent, each worker bakes its own.
+    pool->run([pool, &allocated, &bakeRange](unsigned int worker)
+	      {
+		bakeRange(allocated.size() * worker / pool->getSize(), allocated.size() * (worker + 1u) / pool->getSize());
+	      });
+}
+
+void DistanceField::shift(Vect<2u, int> delta)
+{
+  std::vector<std::unique_ptr<Chunk>> moved(chunks.size());
+  std::vector<Packed const *> movedSamples(samples.size(), nullptr);
+
+  for (Vect<2u, unsigned int> chunk(0u, 0u); chunk[1] != chunkCount[1]; ++chunk[1])
+    for (chunk[0] = 0u; chunk[0] != chunkCount[0]; ++chunk[0])
+      {
+	long const x((long)chunk[0] - delta[0]);
+	long const y((long)chunk[1] - delta[1]);
+
+	if (x >= 0l && y >= 0l && x < (long)chunkCount[0] && y < (long)chunkCount[1])
+	  {
+	    moved[(unsigned int)x + (unsigned int)y * chunkCount[0]] = std::move(chunks[chunk[0] + chunk[1] * chunkCount[0]]);
+	    movedSamples[(unsigned int)x + (unsigned int)y * chunkCount[0]] = samples[chunk[0] + chunk[1] * chunkCount[0]];
+	  }
+      }
+  chunks.swap(moved);
+  samples.swap(movedSamples);
+}
+
+void DistanceField::loadRows(Terrain const &terrain, Vect<2u, unsigned int> chunk, unsigned int row, Rows &rows)
+{
+  long const x((long)(chunk[0] * Terrain::CHUNK_SIZE));
+  long const y((long)(chunk[1] * Terrain::CHUNK_SIZE + row));
+
+  for (unsigned int i(0u); i != rows.size(); ++i)
+    for (unsigned int j(0u); j != 3u; ++j)
+      rows[i][j] = terrain.getSolidRow(x + ((long)j - 1l) * (long)Terrain::CHUNK_SIZE, y + (long)i - REACH);
+}
+
+DistanceField::Candidates const &DistanceField::candidates()
+{
+  static Candidates const table([]()
+				{
+				  Candidates table;
+
+				  for (Vect<2u, unsigned int> sub(0u, 0u); sub[1] != RESOLUTION; ++sub[1])
+				    for (sub[0] = 0u; sub[0] != RESOLUTION; ++sub[0])
+				      {
+					// Relative to the tile's corner, offsets are multiples of 1 / RESOLUTION, so exact.
+					Vect<2u, double> const point((Vect<2u, double>(sub) + Vect<2u, double>{0.5, 0.5}) / (double)RESOLUTION);
+					std::vector<std::pair<double, Candidate>> found;
+
+					for (int y(-REACH); y <= REACH; ++y)
+					  for (int x(-REACH); x <= REACH; ++x)
+					    {
+					      Vect<2u, double> const square((double)x, (double)y);
+					      Vect<2u, double> const onSquare(std::min(std::max(point[0], square[0]), square[0] + 1.0),
+									      std::min(std::max(point[1], square[1]), square[1] + 1.0));
+					      double const length2((point - onSquare).length2());
+					      double const distance(std::sqrt(length2));
+					      Vect<2u, double> const normal((onSquare - point).normalized());
+
+					      if ((!x && !y) || length2 >= MAX_DISTANCE * MAX_DISTANCE)
+						continue ;
+					      found.emplace_back(length2, Candidate{(unsigned int)(x + REACH) + (unsigned int)(y + REACH) * WINDOW_SIDE,
+						    {(std::int16_t)std::lround(distance * DISTANCE_SCALE),
+							{(std::int8_t)std::lround(-normal[0] * NORMAL_SCALE), (std::int8_t)std::lround(-normal[1] * NORMAL_SCALE)}},
+						      {(std::int16_t)std::lround(-distance * DISTANCE_SCALE),
+							  {(std::int8_t)std::lround(normal[0] * NORMAL_SCALE), (std::int8_t)std::lround(normal[1] * NORMAL_SCALE)}}});
+					    }
+					std::stable_sort(found.begin(), found.end(), [](auto const &a, auto const &b)
+							 {
+							   return a.first < b.first;
+							 });
+					for (auto const &candidate : found)
+					  table[sub[0] + sub[1] * RESOLUTION].push_back(candidate.second);
+				      }
+				  return table;
+				}());
+
+  return table;
+}
+
+void DistanceField::bakeChunk(Terrain const &terrain, Vect<2u, unsigned int> chunk)
+{
+  Candidates const &table(candidates());
+  auto &owned(chunks[chunk[0] + chunk[1] * chunkCount[0]]);
+  Rows rows;
+  std::uint32_t lastColumn(0u);
+  Packed const farInFloor{(std::int16_t)std::lround(MAX_DISTANCE * DISTANCE_SCALE), {0, 0}};
+  Packed const farInWall{(std::int16_t)std::lround(-MAX_DISTANCE * DISTANCE_SCALE), {0, 0}};
+
+  for (unsigned int y(0u); y != WINDOW_SIDE; ++y)
+    lastColumn |= 1u << (y * WINDOW_SIDE + WINDOW_SIDE - 1u);
+  owned.reset(new Chunk(chunkSamples * chunkSamples));
+  samples[chunk[0] + chunk[1] * chunkCount[0]] = owned->data();
+  for (Vect<2u, unsigned int> tile(0u, 0u); tile[1] != Terrain::CHUNK_SIZE; ++tile[1])
+    {
+      // Solidity of the tiles within REACH of the current one, as laid out by Candidate::bit.
+      // Slides right with the tile, the new column being loaded in each row's top bit.
+      std::uint32_t window(0u);
+      auto const slide([&rows, &window, lastColumn](int x)
+		       {
+			 window = (window >> 1u) & ~lastColumn;
+			 for (int y(-REACH); y <= REACH; ++y)
+			   window |= (std::uint32_t)isSolid(rows, x, y) << ((unsigned int)(y + REACH) * WINDOW_SIDE + WINDOW_SIDE - 1u);
+		       });
+
+      loadRows(terrain, chunk, tile[1], rows);
+      for (int x(-REACH); x != REACH; ++x)
+	slide(x);
+      for (tile[0] = 0u; tile[0] != Terrain::CHUNK_SIZE; ++tile[0])
+	{
+	  slide((int)tile[0] + REACH);
+
+	  bool const solid(isSolid(rows, (int)tile[0], 0));
+	  std::uint32_t const others(solid ? ~window & WINDOW_MASK : window);
+
+	  for (Vect<2u, unsigned int> sub(0u, 0u); sub[1] != RESOLUTION; ++sub[1])
+	    for (sub[0] = 0u; sub[0] != RESOLUTION; ++sub[0])
+	      {
+		Packed &packed((*owned)[tile[0] * RESOLUTION + sub[0] + (tile[1] * RESOLUTION + sub[1]) * chunkSamples]);
+
+		packed = solid ? farInWall : farInFloor;
+		if (!others)
+		  continue ;
+		for (Candidate const &candidate : table[sub[0] + sub[1] * RESOLUTION])
+		  if ((others >> candidate.bit) & 1u)
+		    {
+		      packed = solid ? candidate.inWall : candidate.inFloor;
+		      break ;
+		    }
+	      }
+	}
+    }
+}
@@ -4,46 +4,56 @@
 #include "Entity.hpp"
 #include "AnimatedEntity.hpp"
 #include "Projectile.hpp"
+#include "EntityPool.hpp"
+#include "Instance.hpp"
 
-Entity EntityFactory::spawnOgreHead(void)
+EntityFactory::EntityFactory(Renderer &renderer)
+  : renderer(renderer)
+  , pool(std::make_shared<EntityPool>(renderer.getSceneManager()))
 {
-  Entity ogre(renderer, "ogrehead.mesh");
+}
+
+void EntityFactory::updatePool(void)
+{
+  pool->nextFrame();
+}
+
+Instance EntityFactory::spawnOgreHead(void)
+{
+  Instance ogre(pool->acquire("ogrehead.mesh"));
 
-  ogre.getOgre()->setCastShadows(false);
-  ogre.getNode()->setScale(1.0f / 150.0f, 1.0f / 150.0f, 1.0f / 150.0f);
+  ogre.setScale(1.0f / 150.0f);
   return ogre;
 }
 
-Entity EntityFactory::spawnProjectile(unsigned int projectileType)
+Instance EntityFactory::spawnProjectile(unsigned int projectileType)
 {
-  Entity entity;
+  Instance entity;
 
   if (projectileType == ProjectileType::COOLDOWN_RESET)
     {
-      entity = Entity(renderer, "feather.mesh");
-      entity.getNode()->setScale(1.0f / 4.0f, 1.0f / 4.0f, 1.0f / 4.0f);
+      entity = pool->acquire("feather.mesh");
+      entity.setScale(1.0f / 4.0f);
     }
   else if (projectileType >= ProjectileType::HEAL && projectileType <= ProjectileType::GOLD50)
     {
       if (projectileType == ProjectileType::HEAL)
-	entity = Entity(renderer, "heart.mesh");
+	entity = pool->acquire("heart.mesh");
       else
 	{
-	  entity = Entity(renderer, Vect<4u, std::string>{
+	  entity = pool->acquire(Vect<4u, std::string>{
 	      "rupee_green.mesh",
 		"rupee_blue.mesh",
 		"rupee_red.mesh",
 		"rupee_purple.mesh",
 		}[projectileType - ProjectileType::GOLD]);
 	}
-      entity.getNode()->setScale(1.0f / 3.0f, 1.0f / 3.0f, 1.0f / 3.0f);
+      entity.setScale(1.0f / 3.0f);
     }
   else if (projectileType != ProjectileType::EXPLOSION &&
 	   projectileType != ProjectileType::HIT1 &&
 	   projectileType != ProjectileType::HIT2)
-    entity = Entity(renderer, "ogrehead.mesh");
-  if (entity.getOgre())
-    entity.getOgre()->setCastShadows(false);
+    entity = pool->acquire("ogrehead.mesh");
   return entity;
 }
 
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <OgreMeshManager.h>
+#include <OgreSubMesh.h>
+#include "EntityPool.hpp"
+
+constexpr unsigned int const EntityPool::PEAK_WINDOW;
+constexpr unsigned int const EntityPool::STEP;
+constexpr unsigned int const EntityPool::INSTANCES_PER_BATCH;
+
+EntityPool::EntityPool(Ogre::SceneManager &sceneManager)
+  : sceneManager(sceneManager)
+  , buckets()
+  , bucketIds()
+  , frame(0u)
+{
+}
+
+EntityPool::~EntityPool()
+{
+  // Managers own their instances.
+  for (Bucket &bucket : buckets)
+    for (Ogre::InstanceManager *manager : bucket.managers)
+      sceneManager.destroyInstanceManager(manager);
+}
+
+unsigned int EntityPool::getBucket(std::string const &mesh)
+{
+  auto const found(bucketIds.find(mesh));
+
+  if (found != bucketIds.end())
+    return found->second;
+
+  Ogre::MeshPtr const meshPtr(Ogre::MeshManager::getSingleton().load(mesh, Ogre::ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME));
+  Bucket bucket{{}, {}, {}, 0u, 0u, 0u};
+
+  for (unsigned short i(0u); i != meshPtr->getNumSubMeshes(); ++i)
+    {
+      Ogre::InstanceManager *manager(sceneManager.createInstanceManager(mesh + "/" + std::to_string(i), mesh,
+									Ogre::ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME,
+									Ogre::InstanceManager::HWInstancingBasic,
+									INSTANCES_PER_BATCH, 0u, i));
+
+      manager->setSetting(Ogre::InstanceManager::CAST_SHADOWS, false);
+      bucket.managers.push_back(manager);
+      bucket.materials.push_back(meshPtr->getSubMesh(i)->getMaterialName() + "/Instanced");
+    }
+  buckets.push_back(std::move(bucket));
+  bucketIds.emplace(mesh, (unsigned int)buckets.size() - 1u);
+  return (unsigned int)buckets.size() - 1u;
+}
+
+EntityPool::Parts EntityPool::create(Bucket const &bucket)
+{
+  Parts parts;
+
+  for (unsigned int i(0u); i != bucket.managers.size(); ++i)
+    {
+      parts.push_back(sceneManager.createInstancedEntity(bucket.materials[i], bucket.managers[i]->getName()));
+      parts.back()->setInUse(false);
+    }
+  return parts;
+}
+
+void EntityPool::destroy(Parts &parts)
+{
+  for (Ogre::InstancedEntity *part : parts)
+    sceneManager.destroyInstancedEntity(part);
+}
+
+Instance EntityPool::acquire(std::string const &mesh)
+{
+  unsigned int const id(getBucket(mesh));
+  Bucket &bucket(buckets[id]);
+  Parts parts;
+
+  if (bucket.free.empty())
+    parts = create(bucket);
+  else
+    {
+      parts = std::move(bucket.free.back());
+      bucket.free.pop_back();
+    }
+  bucket.windowPeak = std::max(bucket.windowPeak, ++bucket.inUse);
+  for (Ogre::InstancedEntity *part : parts)
+    {
+      part->setInUse(true);
+      part->setOrientation(Ogre::Quaternion::IDENTITY, false);
+      part->setScale(Ogre::Vector3::UNIT_SCALE, false);
+      part->setPosition(Ogre::Vector3::ZERO);
+    }
+  return Instance(std::move(parts), id, shared_from_this());
+}
+
+void EntityPool::release(Instance &instance)
+{
+  if (instance.parts.empty())
+    return ;
+
+  Bucket &bucket(buckets[instance.bucket]);
+
+  for (Ogre::InstancedEntity *part : instance.parts)
+    part->setInUse(false);
+  bucket.free.push_back(std::move(instance.parts));
+  instance.parts.clear();
+  --bucket.inUse;
+}
+
+void EntityPool::nextFrame()
+{
+  bool const windowEnd(++frame == PEAK_WINDOW);
+
+  if (windowEnd)
+    frame = 0u;
+  for (Bucket &bucket : buckets)
+    {
+      unsigned int const target(std::max(bucket.peak, bucket.windowPeak));
+
+      for (unsigned int i(0u); i != STEP && bucket.inUse + bucket.free.size() < target; ++i)
+	bucket.free.push_back(create(bucket));
+      for (unsigned int i(0u); i != STEP && bucket.inUse + bucket.free.size() > target && !bucket.free.empty(); ++i)
+	{
+	  destroy(bucket.free.back());
+	  bucket.free.pop_back();
+	}
+      if (windowEnd)
+	{
+	  bucket.peak = bucket.windowPeak;
+	  bucket.windowPeak = bucket.inUse;
+	}
+    }
+}
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include "FlowField.hpp"
+#include "Terrain.hpp"
+
+constexpr unsigned int const FlowField::REACH;
+constexpr std::uint16_t const FlowField::UNREACHABLE;
+
+FlowField::FlowField()
+  : origin{0, 0}
+  , size{0u, 0u}
+  , distances()
+  , directions()
+  , queue()
+  , targets()
+{
+}
+
+bool FlowField::update(Terrain const &terrain, std::vector<Vect<2u, unsigned int>> const &targets)
+{
+  if (std::equal(targets.begin(), targets.end(), this->targets.begin(), this->targets.end(),
+		 [](auto const &a, auto const &b)
+		 {
+		   return a.equals(b);
+		 }))
+    return false;
+  this->targets = targets;
+  if (targets.empty())
+    {
+      size = {0u, 0u};
+      return true;
+    }
+
+  Vect<2u, int> min(targets.front());
+  Vect<2u, int> max(targets.front());
+
+  for (Vect<2u, int> const target : targets)
+    for (unsigned int i(0u); i != 2u; ++i)
+      {
+	min[i] = std::min(min[i], target[i]);
+	max[i] = std::max(max[i], target[i]);
+      }
+  for (unsigned int i(0u); i != 2u; ++i)
+    {
+      origin[i] = std::max(min[i] - (int)REACH, 0);
+      size[i] = (unsigned int)(std::min(max[i] + (int)REACH + 1, (int)terrain.getSize()[i]) - origin[i]);
+    }
+  distances.assign(size[0] * size[1], UNREACHABLE);
+  directions.assign(size[0] * size[1], Vect<2u, std::int8_t>{(std::int8_t)0, (std::int8_t)0});
+  queue.clear();
+  for (Vect<2u, int> const target : targets)
+    if (contains(target) && distances[indexOf(target)])
+      {
+	distances[indexOf(target)] = 0u;
+	queue.push_back(indexOf(target));
+      }
+
+  constexpr int const offsets[4][2]{{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+  for (unsigned int read(0u); read != queue.size(); ++read)
+    {
+      Vect<2u, int> const tile(origin[0] + (int)(queue[read] % size[0]), origin[1] + (int)(queue[read] / size[0]));
+
+      for (auto const &offset : offsets)
+	{
+	  Vect<2u, int> const next(tile[0] + offset[0], tile[1] + offset[1]);
+
+	  if (contains(next) && distances[indexOf(next)] == UNREACHABLE
+	      && !terrain.isSolid(Vect<2u, unsigned int>(next)))
+	    {
+	      distances[indexOf(next)] = (std::uint16_t)(distances[queue[read]] + 1u);
+	      queue.push_back(indexOf(next));
+	    }
+	}
+    }
+
+  // Steepest descent over the 8 neighbours, diagonals only when both sides are open.
+  for (unsigned int index : queue)
+    {
+      Vect<2u, int> const tile(origin[0] + (int)(index % size[0]), origin[1] + (int)(index / size[0]));
+      std::uint16_t best(distances[index]);
+
+      for (int y(-1); y <= 1; ++y)
+	for (int x(-1); x <= 1; ++x)
+	  {
+	    Vect<2u, int> const next(tile[0] + x, tile[1] + y);
+
+	    if (!contains(next) || distances[indexOf(next)] >= best
+		|| (x && y && (getDistance({tile[0] + x, tile[1]}) == UNREACHABLE
+			       || getDistance({tile[0], tile[1] + y}) == UNREACHABLE)))
+	      continue ;
+	    best = distances[indexOf(next)];
+	    directions[index] = {(std::int8_t)x, (std::int8_t)y};
+	  }
+    }
+  return true;
+}
@@ -6,6 +6,8 @@
 #include "Joystick.hpp"
 #include "PyPlugin.hpp"
 #include "LevelScene.hpp"
+#include "LevelPipeline.hpp"
+#include "Logic.hpp"
 
 // Constructor
 
@@ -14,6 +16,10 @@ Game::Game()
   , window(nullptr)
   , inputManager(nullptr)
 {
+  // The first level is generated while menus are shown
+  if (!Logic::isEndless())
+    LevelPipeline::getPipeline().prefetch(LevelPipeline::FIRST_LEVEL);
+
   setupResources();
   setupRenderSystem();
 
@@ -41,9 +47,6 @@ Game::Game()
     return (static_cast<Scene *>(new SceneStart(*renderer)));
   }));
 
-  // Loading wall mesh
-  LevelScene::createWallMesh();
-
   // Adding the joysticks
   for (size_t i = 0; i < 4; i++)
     addJoystick(i);
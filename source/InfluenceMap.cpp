@@ -0,0 +1,135 @@
+#include <algorithm>
+#include "InfluenceMap.hpp"
+
+constexpr unsigned int const InfluenceMap::CELL_SHIFT;
+constexpr unsigned int const InfluenceMap::CELL_SIZE;
+constexpr float const InfluenceMap::DECAY;
+constexpr unsigned int const InfluenceMap::DECAY_TICKS;
+
+InfluenceMap::InfluenceMap()
+  : size{0u, 0u}
+  , cells()
+  , decayTable()
+  , tick(0u)
+{
+  float factor(1.0f);
+
+  for (float &entry : decayTable)
+    {
+      entry = factor;
+      factor *= DECAY;
+    }
+}
+
+void InfluenceMap::resize(Vect<2u, unsigned int> terrainSize)
+{
+  size = {(terrainSize[0] + CELL_SIZE - 1u) >> CELL_SHIFT, (terrainSize[1] + CELL_SIZE - 1u) >> CELL_SHIFT};
+  cells.assign(size[0] * size[1], Cell{{}, {}, {}});
+  tick = 0u;
+}
+
+void InfluenceMap::shift(Vect<2u, int> delta)
+{
+  Vect<2u, int> const cellDelta(delta[0] / (int)CELL_SIZE, delta[1] / (int)CELL_SIZE);
+  std::vector<Cell> moved(cells.size(), Cell{{}, {}, {}});
+
+  for (Vect<2u, unsigned int> cell(0u, 0u); cell[1] != size[1]; ++cell[1])
+    for (cell[0] = 0u; cell[0] != size[0]; ++cell[0])
+      {
+	long const x((long)cell[0] - cellDelta[0]);
+	long const y((long)cell[1] - cellDelta[1]);
+
+	if (x >= 0l && y >= 0l && x < (long)size[0] && y < (long)size[1])
+	  moved[(unsigned int)x + (unsigned int)y * size[0]] = cells[cell[0] + cell[1] * size[0]];
+      }
+  cells.swap(moved);
+}
+
+void InfluenceMap::nextTick()
+{
+  ++tick;
+}
+
+unsigned int InfluenceMap::cellOf(Vect<2u, double> pos) const
+{
+  if (!(pos[0] >= 0.0 && pos[1] >= 0.0))
+    return ~0u;
+
+  Vect<2u, unsigned int> const cell((unsigned int)pos[0] >> CELL_SHIFT, (unsigned int)pos[1] >> CELL_SHIFT);
+
+  if (cell[0] >= size[0] || cell[1] >= size[1])
+    return ~0u;
+  return cell[0] + cell[1] * size[0];
+}
+
+float InfluenceMap::decayed(Cell const &cell, Layer layer) const
+{
+  unsigned int const elapsed(tick - cell.traceTick[layer]);
+
+  return elapsed < DECAY_TICKS ? cell.trace[layer] * decayTable[elapsed] : 0.0f;
+}
+
+void InfluenceMap::enter(unsigned int cell, Layer layer)
+{
+  cells[cell].count[layer] += 1.0f;
+}
+
+void InfluenceMap::leave(unsigned int cell, Layer layer)
+{
+  Cell &left(cells[cell]);
+
+  left.count[layer] -= 1.0f;
+  left.trace[layer] = decayed(left, layer) + 1.0f;
+  left.traceTick[layer] = tick;
+}
+
+void InfluenceMap::move(Fixture &fixture, Layer layer, bool active)
+{
+  unsigned int const cell(active ? cellOf(fixture.pos) : ~0u);
+
+  if (cell == fixture.influenceCell)
+    return ;
+  if (fixture.influenceCell != ~0u)
+    leave(fixture.influenceCell, layer);
+  if (cell != ~0u)
+    enter(cell, layer);
+  fixture.influenceCell = cell;
+}
+
+float InfluenceMap::get(Layer layer, Vect<2u, double> pos) const
+{
+  unsigned int const cell(cellOf(pos));
+
+  if (cell == ~0u)
+    return 0.0f;
+  return cells[cell].count[layer] + decayed(cells[cell], layer);
+}
+
+Vect<2u, double> InfluenceMap::lowest(Layer layer, Vect<2u, double> pos) const
+{
+  unsigned int const center(cellOf(pos));
+
+  if (center == ~0u)
+    return pos;
+
+  Vect<2u, unsigned int> const centerCell(center % size[0], center / size[0]);
+  unsigned int best(center);
+  float bestValue(get(layer, pos));
+
+  for (unsigned int y(centerCell[1] ? centerCell[1] - 1u : 0u); y != std::min(centerCell[1] + 2u, size[1]); ++y)
+    for (unsigned int x(centerCell[0] ? centerCell[0] - 1u : 0u); x != std::min(centerCell[0] + 2u, size[0]); ++x)
+      {
+	Cell const &cell(cells[x + y * size[0]]);
+	float const value(cell.count[layer] + decayed(cell, layer));
+
+	if (value < bestValue)
+	  {
+	    best = x + y * size[0];
+	    bestValue = value;
+	  }
+      }
+  if (best == center)
+    return pos;
+  return {(double)((best % size[0]) << CELL_SHIFT) + CELL_SIZE * 0.5,
+      (double)((best / size[0]) << CELL_SHIFT) + CELL_SIZE * 0.5};
+}
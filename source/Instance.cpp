@@ -0,0 +1,66 @@
+#include <cmath>
+#include "Instance.hpp"
+#include "EntityPool.hpp"
+
+Instance::Instance()
+  : parts()
+  , bucket(0u)
+  , pool(nullptr)
+{
+}
+
+Instance::Instance(std::vector<Ogre::InstancedEntity *> &&parts, unsigned int bucket, std::shared_ptr<EntityPool> pool)
+  : parts(std::move(parts))
+  , bucket(bucket)
+  , pool(std::move(pool))
+{
+}
+
+Instance::Instance(Instance &&other)
+  : Instance()
+{
+  std::swap(parts, other.parts);
+  std::swap(bucket, other.bucket);
+  std::swap(pool, other.pool);
+}
+
+Instance &Instance::operator=(Instance &&other)
+{
+  std::swap(parts, other.parts);
+  std::swap(bucket, other.bucket);
+  std::swap(pool, other.pool);
+  return *this;
+}
+
+Instance::~Instance()
+{
+  if (pool)
+    pool->release(*this);
+}
+
+bool Instance::isEmpty() const
+{
+  return parts.empty();
+}
+
+void Instance::setScale(Ogre::Real scale)
+{
+  for (Ogre::InstancedEntity *part : parts)
+    part->setScale(Ogre::Vector3(scale));
+}
+
+Ogre::Quaternion Instance::directionToOrientation(Ogre::Real x, Ogre::Real z)
+{
+  if (x == 0.0f && z == 0.0f)
+    return Ogre::Quaternion::IDENTITY;
+  return Ogre::Quaternion(Ogre::Radian(std::atan2(x, z)), Ogre::Vector3::UNIT_Y);
+}
+
+void Instance::setTransform(Ogre::Vector3 const &position, Ogre::Quaternion const &orientation)
+{
+  for (Ogre::InstancedEntity *part : parts)
+    {
+      part->setOrientation(orientation, false);
+      part->setPosition(position);
+    }
+}
@@ -0,0 +1,193 @@
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <fstream>
+#include <stdexcept>
+#include "LevelCache.hpp"
+#include "MappedFile.hpp"
+
+#if defined _WIN32
+# include <direct.h>
+#else
+# include <sys/stat.h>
+#endif
+
+constexpr std::uint32_t const LevelCache::FORMAT_VERSION;
+
+namespace
+{
+  constexpr char const MAGIC[4]{'S', 'S', 'K', 'L'};
+
+  constexpr std::size_t const TILES_SIZE{sizeof(Terrain::Chunk::solid) + sizeof(Terrain::Chunk::roomIds)};
+
+  constexpr std::size_t align(std::size_t offset)
+  {
+    return (offset + 7u) & ~std::size_t(7u);
+  }
+}
+
+LevelCache::LevelCache(std::string const &directory)
+  : directory(directory)
+{
+}
+
+std::string LevelCache::getPath(unsigned int seed) const
+{
+  return directory + "/level-" + std::to_string(seed) + ".bin";
+}
+
+bool LevelCache::load(unsigned int seed, Terrain &terrain) const
+{
+  std::shared_ptr<MappedFile const> mapping;
+
+  try
+    {
+      mapping = std::make_shared<MappedFile const>(getPath(seed));
+    }
+  catch (std::runtime_error const &)
+    {
+      return false;
+    }
+
+  char const *data(mapping->getData());
+  std::size_t const fileSize(mapping->getSize());
+  Header header;
+
+  if (fileSize < sizeof(Header))
+    return false;
+  std::memcpy(&header, data, sizeof(Header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC))
+      || header.formatVersion != FORMAT_VERSION
+      || header.generatorVersion != Terrain::GENERATOR_VERSION
+      || header.seed != seed
+      || header.chunkSamples != Terrain::CHUNK_SIZE * DistanceField::RESOLUTION
+      || header.size[0] > Terrain::MAX_SIZE || header.size[1] > Terrain::MAX_SIZE)
+    return false;
+
+  Vect<2u, unsigned int> const size(header.size[0], header.size[1]);
+  unsigned int const chunkTotal(((size[0] + Terrain::CHUNK_SIZE - 1u) >> Terrain::CHUNK_SHIFT)
+				* ((size[1] + Terrain::CHUNK_SIZE - 1u) >> Terrain::CHUNK_SHIFT));
+  std::size_t const samplesSize(header.chunkSamples * header.chunkSamples * sizeof(DistanceField::Packed));
+  std::size_t offset(sizeof(Header));
+
+  // Layout: header, rooms, chunk presence, tiles of present chunks, then their distance field.
+  std::size_t const roomsOffset(offset);
+  offset = align(offset + header.roomCount * sizeof(PackedRoom));
+  std::size_t const presentOffset(offset);
+  if (offset + chunkTotal > fileSize)
+    return false;
+
+  unsigned int presentCount(0u);
+  for (unsigned int i(0u); i != chunkTotal; ++i)
+    presentCount += !!data[presentOffset + i];
+  offset = align(offset + chunkTotal);
+
+  std::size_t const tilesOffset(offset);
+  std::size_t const fieldOffset(tilesOffset + presentCount * TILES_SIZE);
+  if (fieldOffset + presentCount * samplesSize != fileSize)
+    return false;
+
+  terrain.resize(size);
+  terrain.seed = seed;
+  terrain.rooms.clear();
+  for (unsigned int i(0u); i != header.roomCount; ++i)
+    {
+      PackedRoom room;
+
+      std::memcpy(&room, data + roomsOffset + i * sizeof(PackedRoom), sizeof(PackedRoom));
+      terrain.rooms.emplace_back(Vect<2u, double>{room.pos[0], room.pos[1]}, room.id, !!room.mobsSpawned);
+    }
+
+  DistanceField &field(terrain.distanceField);
+
+  field.chunkCount = terrain.chunkCount;
+  field.chunks.clear();
+  field.chunks.resize(chunkTotal);
+  field.samples.assign(chunkTotal, nullptr);
+  for (unsigned int i(0u), present(0u); i != chunkTotal; ++i)
+    if (data[presentOffset + i])
+      {
+	std::unique_ptr<Terrain::Chunk> chunk(new Terrain::Chunk());
+
+	std::memcpy(chunk->solid.data(), data + tilesOffset + present * TILES_SIZE, sizeof(chunk->solid));
+	std::memcpy(chunk->roomIds.data(), data + tilesOffset + present * TILES_SIZE + sizeof(chunk->solid),
+		    sizeof(chunk->roomIds));
+	terrain.chunks[i] = std::move(chunk);
+	field.samples[i] = reinterpret_cast<DistanceField::Packed const *>(data + fieldOffset + present * samplesSize);
+	++present;
+      }
+  field.mapping = std::move(mapping);
+  terrain.roomGraph.build(terrain);
+  return true;
+}
+
+void LevelCache::store(Terrain const &terrain) const
+{
+#if defined _WIN32
+  _mkdir(directory.c_str());
+#else
+  mkdir(directory.c_str(), 0755);
+#endif
+
+  for (unsigned int i(0u); i != terrain.chunks.size(); ++i)
+    if (terrain.chunks[i] && !terrain.distanceField.samples[i])
+      return ;
+
+  std::string const path(getPath(terrain.seed));
+  std::string const temporary(path + ".tmp");
+  std::size_t const samplesSize(terrain.distanceField.chunkSamples * terrain.distanceField.chunkSamples
+				* sizeof(DistanceField::Packed));
+  char const padding[8]{};
+  Header header{{MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3]}, FORMAT_VERSION, Terrain::GENERATOR_VERSION, terrain.seed,
+      {terrain.size[0], terrain.size[1]}, (std::uint32_t)terrain.rooms.size(), terrain.distanceField.chunkSamples};
+
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    std::size_t offset(0u);
+    auto const write([&file, &offset](void const *data, std::size_t size)
+		     {
+		       file.write(static_cast<char const *>(data), (std::streamsize)size);
+		       offset += size;
+		     });
+    auto const pad([&write, &offset, &padding]()
+		   {
+		     write(padding, align(offset) - offset);
+		   });
+
+    write(&header, sizeof(Header));
+    for (Terrain::Room const &room : terrain.rooms)
+      {
+	PackedRoom const packed{{room.pos[0], room.pos[1]}, room.id, room.mobsSpawned};
+
+	write(&packed, sizeof(PackedRoom));
+      }
+    pad();
+    for (auto const &chunk : terrain.chunks)
+      {
+	char const present(!!chunk);
+
+	write(&present, 1u);
+      }
+    pad();
+    for (auto const &chunk : terrain.chunks)
+      if (chunk)
+	{
+	  write(chunk->solid.data(), sizeof(chunk->solid));
+	  write(chunk->roomIds.data(), sizeof(chunk->roomIds));
+	}
+    for (unsigned int i(0u); i != terrain.chunks.size(); ++i)
+      if (terrain.chunks[i])
+	write(terrain.distanceField.samples[i], samplesSize);
+    if (!file)
+      {
+	file.close();
+	std::remove(temporary.c_str());
+	return ;
+      }
+  }
+#if defined _WIN32
+  std::remove(path.c_str());
+#endif
+  // Readers never see a partly written file.
+  std::rename(temporary.c_str(), path.c_str());
+}
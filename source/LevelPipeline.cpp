@@ -0,0 +1,179 @@
+#include <algorithm>
+#include "LevelPipeline.hpp"
+
+constexpr unsigned int const LevelPipeline::FIRST_LEVEL;
+constexpr unsigned int const LevelPipeline::MAX_READY;
+
+LevelPipeline::LevelPipeline()
+  : lock()
+  , wake()
+  , done()
+  , requests()
+  , ready()
+  , generating(0u)
+  , busy(false)
+  , window{0u, {0u, 0u}, {0l, 0l}}
+  , windowQueued(false)
+  , windowBusy(false)
+  , readyWindow()
+  , stop(false)
+  , cache()
+  , pool()
+  , thread([this]()
+	   {
+	     work();
+	   })
+{
+}
+
+LevelPipeline::~LevelPipeline()
+{
+  {
+    std::lock_guard<std::mutex> const lock_guard(lock);
+
+    stop = true;
+  }
+  wake.notify_all();
+  thread.join();
+}
+
+LevelPipeline &LevelPipeline::getPipeline()
+{
+  static LevelPipeline pipeline;
+
+  return pipeline;
+}
+
+bool LevelPipeline::isReady(unsigned int seed) const
+{
+  return std::any_of(ready.begin(), ready.end(), [seed](std::pair<unsigned int, Level> const &level)
+		     {
+		       return level.first == seed;
+		     });
+}
+
+LevelPipeline::Level LevelPipeline::build(unsigned int seed)
+{
+  Level level;
+
+  if (!cache.load(seed, level.terrain))
+    {
+      level.terrain.generateLevel(seed, Terrain::DEFAULT_ROOM_COUNT, &pool);
+      cache.store(level.terrain);
+    }
+  level.meshes = TerrainMesher::meshTerrain(level.terrain);
+  return level;
+}
+
+void LevelPipeline::work()
+{
+  while (true)
+    {
+      unsigned int seed;
+
+      {
+	std::unique_lock<std::mutex> unique_lock(lock);
+
+	wake.wait(unique_lock, [this]()
+		  {
+		    return stop || windowQueued || (!requests.empty() && ready.size() < MAX_READY);
+		  });
+	if (stop)
+	  return ;
+	if (windowQueued)
+	  {
+	    Window const next(window);
+	    Terrain terrain;
+
+	    windowQueued = false;
+	    windowBusy = true;
+	    unique_lock.unlock();
+	    terrain.startEndless(next.seed, next.chunkCount, next.origin, &pool);
+	    unique_lock.lock();
+	    readyWindow = std::make_unique<Terrain>(std::move(terrain));
+	    windowBusy = false;
+	    continue ;
+	  }
+	seed = requests.front();
+	requests.pop_front();
+	generating = seed;
+	busy = true;
+      }
+
+      Level level(build(seed));
+
+      {
+	std::lock_guard<std::mutex> const lock_guard(lock);
+
+	ready.emplace_back(seed, std::move(level));
+	busy = false;
+      }
+      done.notify_all();
+    }
+}
+
+void LevelPipeline::prefetch(unsigned int seed)
+{
+  {
+    std::lock_guard<std::mutex> const lock_guard(lock);
+
+    if ((busy && generating == seed) || isReady(seed)
+	|| std::find(requests.begin(), requests.end(), seed) != requests.end())
+      return ;
+    requests.push_back(seed);
+  }
+  wake.notify_one();
+}
+
+LevelPipeline::Level LevelPipeline::take(unsigned int seed)
+{
+  {
+    std::unique_lock<std::mutex> unique_lock(lock);
+
+    requests.erase(std::remove(requests.begin(), requests.end(), seed), requests.end());
+    done.wait(unique_lock, [this, seed]()
+	      {
+		return !busy || generating != seed;
+	      });
+
+    auto const level(std::find_if(ready.begin(), ready.end(), [seed](std::pair<unsigned int, Level> const &level)
+				  {
+				    return level.first == seed;
+				  }));
+
+    if (level != ready.end())
+      {
+	Level taken(std::move(level->second));
+
+	ready.erase(level);
+	unique_lock.unlock();
+	wake.notify_one();
+	return taken;
+      }
+  }
+  return build(seed);
+}
+
+void LevelPipeline::prefetchWindow(Terrain const &terrain, Vect<2u, long> origin)
+{
+  {
+    std::lock_guard<std::mutex> const lock_guard(lock);
+
+    if (window.origin.equals(origin) && (windowQueued || windowBusy || (readyWindow && readyWindow->getOrigin().equals(origin))))
+      return ;
+    window = Window{terrain.getSeed(), terrain.getChunkCount(), origin};
+    windowQueued = true;
+  }
+  wake.notify_one();
+}
+
+bool LevelPipeline::takeWindow(Vect<2u, long> origin, Terrain &terrain)
+{
+  std::lock_guard<std::mutex> const lock_guard(lock);
+
+  if (!readyWindow || !readyWindow->getOrigin().equals(origin))
+    return false;
+  terrain = std::move(*readyWindow);
+  readyWindow.reset();
+  return true;
+}
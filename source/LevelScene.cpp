@@ -1,19 +1,31 @@
+#include <string>
+#include <limits>
+#include <cmath>
 #include <OgreEntity.h>
 #include <OgreLight.h>
 #include <OgreSceneNode.h>
-#include <OgreStaticGeometry.h>
-#include <OgrePlane.h>
-#include <OgreMeshManager.h>
 #include <OgreManualObject.h>
+#include <OgrePlane.h>
+#include <OgreRay.h>
 #include "EntityFactory.hpp"
 #include "LevelScene.hpp"
 #include "Entity.hpp"
 #include "AudioSource.hpp"
+#include "Terrain.hpp"
+
+constexpr float const LevelScene::VISIBILITY_MARGIN;
+constexpr float const LevelScene::FOOTPRINT_REACH;
 
 LevelScene::LevelScene(Renderer &renderer, std::vector<std::function<AnimatedEntity(Renderer &)>> const &v, std::vector<PlayerId> const &classes, std::vector<Gameplays> const &gp)
   : uiHUD(renderer)
   , uiPause(*this, renderer)
-  , terrainNode(renderer.getSceneManager().getRootSceneNode()->createChildSceneNode())
+  , sceneManager(renderer.getSceneManager())
+  , camera(renderer.getCamera())
+  , terrainChunks()
+  , chunkCount(0u, 0u)
+  , visibleBegin(0u, 0u)
+  , visibleEnd(0u, 0u)
+  , objectCount(0u)
   , inPause(false)
   , cameraNode([&renderer]()
 	       {
@@ -39,8 +51,6 @@ LevelScene::LevelScene(Renderer &renderer, std::vector<std::function<AnimatedEnt
     players.push_back(std::move(fn(renderer)));
   }
 
-  terrainNode->scale(1.0, 1.0, 1.0);
-
   // Hide pause
   uiPause.setUIVisible(false);
 
@@ -53,6 +63,8 @@ LevelScene::~LevelScene() {
     inPause = false;
     uiPause.setUIVisible(false);
   }
+  for (TerrainChunk const &terrainChunk : terrainChunks)
+    destroyChunk(terrainChunk);
 }
 
 void LevelScene::resetSceneCallbacks(Renderer &r) {
@@ -76,139 +88,185 @@ void LevelScene::resetSceneCallbacks(Renderer &r) {
       Joystick::registerGlobalCallback(joystickState::JS_START, goBackToMenu);
     }
 }
-void LevelScene::setTerrain(Terrain const &terrain)
+void LevelScene::setTerrain(Terrain const &terrain, std::vector<TerrainMesher::ChunkMesh> const &meshes)
 {
-  for (unsigned int i(0); i < terrain.getSize()[0]; ++i)
+  std::size_t wallTriangles(0u);
+  std::size_t floorTriangles(0u);
+
+  for (TerrainChunk const &terrainChunk : terrainChunks)
+    destroyChunk(terrainChunk);
+  terrainChunks.clear();
+  chunkCount = terrain.getChunkCount();
+  visibleBegin = {0u, 0u};
+  visibleEnd = {0u, 0u};
+  for (Vect<2u, unsigned int> chunk(0u, 0u); chunk[1] != chunkCount[1]; ++chunk[1])
+    for (chunk[0] = 0u; chunk[0] != chunkCount[0]; ++chunk[0])
+      {
+	TerrainMesher::ChunkMesh const &mesh(meshes[chunk[0] + chunk[1] * chunkCount[0]]);
+
+	wallTriangles += mesh.walls.getTriangleCount();
+	floorTriangles += mesh.floors.getTriangleCount();
+	terrainChunks.push_back(createChunk(chunk, mesh));
+      }
+  std::clog << "Terrain meshed: " << wallTriangles << " wall and " << floorTriangles << " floor triangles" << std::endl;
+  updateTerrainVisibility();
+}
+
+Ogre::ManualObject *LevelScene::createObject(TerrainMesher::Mesh const &mesh, Ogre::SceneNode *node, bool castShadows)
+{
+  if (mesh.indices.empty())
+    return nullptr;
+
+  Ogre::ManualObject *object(sceneManager.createManualObject("Terrain" + std::to_string(objectCount++)));
+
+  object->estimateVertexCount(mesh.vertices.size());
+  object->estimateIndexCount(mesh.indices.size());
+  object->begin("wall", Ogre::RenderOperation::OT_TRIANGLE_LIST);
+  for (TerrainMesher::Vertex const &vertex : mesh.vertices)
     {
-      for (unsigned int j(0); j < terrain.getSize()[1]; ++j)
-	{
-	               
-	  if (terrain.getTile({i, j}).isSolid)
-	    {
-	      Ogre::SceneNode *wallNode(terrainNode->createChildSceneNode());
-	      Ogre::Entity* wall(wallNode->getCreator()->createEntity("WallMesh"));
-		
-	      wall->setCastShadows(true);
-	      wallNode->attachObject(wall);
-	      wallNode->setPosition(static_cast<Ogre::Real>(i), 0.0f, static_cast<Ogre::Real>(j));
-	    }
-	  else
-	    {
-	      Ogre::SceneNode *wallNode(terrainNode->createChildSceneNode());
-	      Ogre::Entity* ground(wallNode->getCreator()->createEntity("GroundMesh"));
- 
-	      ground->setCastShadows(false);
-	      wallNode->attachObject(ground);
-	      wallNode->setPosition(static_cast<Ogre::Real>(i), 0.0f, static_cast<Ogre::Real>(j));
-	    }
-	}
+      object->position(vertex.pos[0], vertex.pos[1], vertex.pos[2]);
+      object->normal(vertex.normal[0], vertex.normal[1], vertex.normal[2]);
+      object->textureCoord(vertex.uv[0], vertex.uv[1]);
     }
+  for (std::uint32_t index : mesh.indices)
+    object->index(index);
+  object->end();
+  object->setCastShadows(castShadows);
+  node->attachObject(object);
+  return object;
 }
 
-void LevelScene::createGroundMesh()
+LevelScene::TerrainChunk LevelScene::createChunk(Vect<2u, unsigned int> chunk, TerrainMesher::ChunkMesh const &mesh)
 {
-  constexpr double const dim(1.0);
-  Ogre::ManualObject obj("GroundObject");
-  unsigned int offset(0u);
-
-  obj.begin("wall", Ogre::RenderOperation::OT_TRIANGLE_LIST); // TODO: add multiple material(s) ?
-  {
-    Vect<3u, double> up{ 0.0, 0.0, 1.0 };
-    Vect<3u, double> right{ 1.0, 0.0, 0.0 };
-
-    for (Vect<2u, double> const &coef : {
-	Vect<2u, double>(0.0, 0.0), Vect<2u, double>(1.0, 0.0),
-	  Vect<2u, double>(0.0, 1.0), Vect<2u, double>(1.0, 1.0)})
-      {
-	Vect<3u, double> const pos((right * coef[0] + up * coef[1]) * dim);
-
-	obj.position(
-		     static_cast<Ogre::Real>(pos[0]),
-		     static_cast<Ogre::Real>(pos[1]),
-		     static_cast<Ogre::Real>(pos[2])
-		     );
-	obj.normal(0.0f, 1.0f, 0.0f);
-	obj.textureCoord(
-			 static_cast<Ogre::Real>(coef[0]),
-			 static_cast<Ogre::Real>(coef[1])
-			 );
-      }
+  Vect<2u, unsigned int> const corner(chunk * Terrain::CHUNK_SIZE);
+  Ogre::SceneNode *node(sceneManager.createSceneNode());
 
-    obj.triangle(offset, offset + 3, offset + 1);
-    obj.triangle(offset, offset + 2, offset + 3);
-    offset += 4;
-  }
-  obj.end();
-  obj.convertToMesh("GroundMesh");
+  // Created detached, updateTerrainVisibility attaches it once seen.
+  node->setPosition(static_cast<Ogre::Real>(corner[0]), 0.0f, static_cast<Ogre::Real>(corner[1]));
+  return {node, createObject(mesh.walls, node, true), createObject(mesh.floors, node, false)};
 }
 
-void LevelScene::createWallMesh()
+void LevelScene::destroyChunk(TerrainChunk const &terrainChunk)
 {
-  constexpr double const dim(1.0);
-  Ogre::ManualObject obj("WallObject");
+  for (Ogre::ManualObject *object : {terrainChunk.walls, terrainChunk.ground})
+    if (object)
+      sceneManager.destroyManualObject(object);
+  sceneManager.destroySceneNode(terrainChunk.node);
+}
 
-  obj.begin("wall", Ogre::RenderOperation::OT_TRIANGLE_LIST); // TODO: add multiple material(s) ?
-  unsigned int offset(0u);
-  { // make the 3 walls
-    Vect<3u, double> start{ 0.0, 0.0, 0.0 };
-    Vect<3u, double> const up{ 0.0, 2.0, 0.0 };
-    Vect<3u, double> right{ 0.0, 0.0, 1.0 };
+void LevelScene::moveChunk(TerrainChunk const &terrainChunk, Ogre::Vector3 offset)
+{
+  terrainChunk.node->translate(offset);
+}
 
-    for (unsigned int i(0); i < 4; ++i)
-      {
-	for (Vect<2u, double> const &coef : {Vect<2u, double>(0.0, 0.0), Vect<2u, double>(1.0, 0.0),
-	      Vect<2u, double>(0.0, 1.0), Vect<2u, double>(1.0, 1.0)})
-	  {
-	    Vect<3u, double> const pos((start + right * coef[0] + up * coef[1]) * dim);
-
-	    obj.position(static_cast<Ogre::Real>(pos[0]),
-			 static_cast<Ogre::Real>(pos[1]),
-			 static_cast<Ogre::Real>(pos[2])
-			 );
-	    obj.normal(static_cast<Ogre::Real>(-right[2]), 0.0f, static_cast<Ogre::Real>(right[0]));
-	    obj.textureCoord(static_cast<Ogre::Real>(coef[0]),
-			     static_cast<Ogre::Real>(coef[1] * 2)
-			     );
-	  }
-	start = start + right;
-	right = {right[2], 0.0, -right[0]};
+void LevelScene::setChunkAttached(Vect<2u, unsigned int> chunk, bool attached)
+{
+  Ogre::SceneNode *node(terrainChunks[chunk[0] + chunk[1] * chunkCount[0]].node);
 
-	obj.triangle(offset, offset + 1, offset + 3);
-	obj.triangle(offset, offset + 3, offset + 2);
-	offset += 4;
-      }
-  }
-  {
-    Vect<3u, double> start{ 0.0, 2.0, 0.0 };
-    Vect<3u, double> up{ 0.0, 0.0, 1.0 };
-    Vect<3u, double> right{ 1.0, 0.0, 0.0 };
-
-    for (Vect<2u, double> const &coef : {
-	Vect<2u, double>(0.0, 0.0), Vect<2u, double>(1.0, 0.0),
-	  Vect<2u, double>(0.0, 1.0), Vect<2u, double>(1.0, 1.0)})
+  if (attached)
+    sceneManager.getRootSceneNode()->addChild(node);
+  else
+    sceneManager.getRootSceneNode()->removeChild(node);
+}
+
+void LevelScene::updateTerrainVisibility()
+{
+  Ogre::Plane const ground(Ogre::Vector3::UNIT_Y, 0.0f);
+  Ogre::Vector2 low(std::numeric_limits<Ogre::Real>::max());
+  Ogre::Vector2 high(std::numeric_limits<Ogre::Real>::lowest());
+
+  for (Ogre::Vector2 const &corner : {Ogre::Vector2(0.0f, 0.0f), Ogre::Vector2(1.0f, 0.0f),
+	Ogre::Vector2(0.0f, 1.0f), Ogre::Vector2(1.0f, 1.0f)})
+    {
+      Ogre::Ray const ray(camera.getCameraToViewportRay(corner.x, corner.y));
+      std::pair<bool, Ogre::Real> const hit(ray.intersects(ground));
+      Ogre::Vector3 const point(ray.getPoint(hit.first ? std::min(hit.second, FOOTPRINT_REACH) : FOOTPRINT_REACH));
+
+      low.makeFloor(Ogre::Vector2(point.x, point.z));
+      high.makeCeil(Ogre::Vector2(point.x, point.z));
+    }
+
+  Vect<2u, unsigned int> begin;
+  Vect<2u, unsigned int> end;
+
+  for (unsigned int i(0u); i != 2u; ++i)
+    {
+      auto const toChunk([this, i](Ogre::Real coord)
+			 {
+			   Ogre::Real const chunk(std::floor(coord / static_cast<Ogre::Real>(Terrain::CHUNK_SIZE)));
+
+			   return chunk < 0.0f ? 0u : std::min((unsigned int)chunk, chunkCount[i]);
+			 });
+
+      begin[i] = toChunk(low[i] - VISIBILITY_MARGIN);
+      end[i] = std::min(toChunk(high[i] + VISIBILITY_MARGIN) + 1u, chunkCount[i]);
+    }
+  if (begin[0] >= end[0] || begin[1] >= end[1])
+    begin = end = {0u, 0u};
+
+  auto const inRange([](Vect<2u, unsigned int> chunk, Vect<2u, unsigned int> rangeBegin, Vect<2u, unsigned int> rangeEnd)
+		     {
+		       return chunk[0] >= rangeBegin[0] && chunk[1] >= rangeBegin[1] && chunk[0] < rangeEnd[0] && chunk[1] < rangeEnd[1];
+		     });
+  // Empty ranges are {0, 0} to {0, 0}, and don't grow the union.
+  Vect<2u, unsigned int> unionBegin(visibleEnd[0] ? visibleBegin : begin);
+  Vect<2u, unsigned int> unionEnd(visibleEnd[0] ? visibleEnd : end);
+
+  for (unsigned int i(0u); end[0] && i != 2u; ++i)
+    {
+      unionBegin[i] = std::min(unionBegin[i], begin[i]);
+      unionEnd[i] = std::max(unionEnd[i], end[i]);
+    }
+
+  for (Vect<2u, unsigned int> chunk(unionBegin); chunk[1] < unionEnd[1]; ++chunk[1])
+    for (chunk[0] = unionBegin[0]; chunk[0] < unionEnd[0]; ++chunk[0])
       {
-	Vect<3u, double> const pos((start + right * coef[0] + up * coef[1]) * dim);
-
-	obj.position(
-		     static_cast<Ogre::Real>(pos[0]),
-		     static_cast<Ogre::Real>(pos[1]),
-		     static_cast<Ogre::Real>(pos[2])
-		     );
-	obj.normal(0.0, 1.0, 0.0);
-	obj.textureCoord(
-			 static_cast<Ogre::Real>(coef[0]),
-			 static_cast<Ogre::Real>(coef[1])
-			 );
+	bool const attached(inRange(chunk, begin, end));
+
+	if (attached != inRange(chunk, visibleBegin, visibleEnd))
+	  setChunkAttached(chunk, attached);
       }
+  visibleBegin = begin;
+  visibleEnd = end;
+}
 
-    obj.triangle(offset, offset + 3, offset + 1);
-    obj.triangle(offset, offset + 2, offset + 3);
-    offset += 4;
-  }
+void LevelScene::shiftTerrain(Terrain const &terrain, Vect<2u, int> delta)
+{
+  Vect<2u, unsigned int> const count(terrain.getChunkCount());
+  Ogre::Vector3 const offset(-static_cast<Ogre::Real>(delta[0] * (int)Terrain::CHUNK_SIZE), 0.0f,
+			     -static_cast<Ogre::Real>(delta[1] * (int)Terrain::CHUNK_SIZE));
+  std::vector<TerrainChunk> moved(terrainChunks.size(), TerrainChunk{nullptr, nullptr, nullptr});
 
-  obj.end();
-  obj.convertToMesh("WallMesh");
-  createGroundMesh();
+  for (Vect<2u, unsigned int> chunk(0u, 0u); chunk[1] != count[1]; ++chunk[1])
+    for (chunk[0] = 0u; chunk[0] != count[0]; ++chunk[0])
+      {
+	TerrainChunk const &terrainChunk(terrainChunks[chunk[0] + chunk[1] * count[0]]);
+	long const x((long)chunk[0] - delta[0]);
+	long const y((long)chunk[1] - delta[1]);
+
+	if (x >= 0l && y >= 0l && x < (long)count[0] && y < (long)count[1])
+	  {
+	    moveChunk(terrainChunk, offset);
+	    moved[(unsigned int)x + (unsigned int)y * count[0]] = terrainChunk;
+	  }
+	else
+	  destroyChunk(terrainChunk);
+      }
+  terrainChunks.swap(moved);
+  for (Vect<2u, unsigned int> chunk(0u, 0u); chunk[1] != count[1]; ++chunk[1])
+    for (chunk[0] = 0u; chunk[0] != count[0]; ++chunk[0])
+      if (!terrainChunks[chunk[0] + chunk[1] * count[0]].node)
+	terrainChunks[chunk[0] + chunk[1] * count[0]] = createChunk(chunk, TerrainMesher::meshChunk(terrain, chunk));
+  // Moved chunks stay attached, entering ones are not.
+  for (unsigned int i(0u); i != 2u; ++i)
+    {
+      visibleBegin[i] = (unsigned int)std::max(0l, std::min((long)visibleBegin[i] - delta[i], (long)count[i]));
+      visibleEnd[i] = (unsigned int)std::max(0l, std::min((long)visibleEnd[i] - delta[i], (long)count[i]));
+    }
+  if (visibleBegin[0] >= visibleEnd[0] || visibleBegin[1] >= visibleEnd[1])
+    visibleBegin = visibleEnd = {0u, 0u};
+  cameraNode->translate(offset);
+  updateTerrainVisibility();
 }
 
 bool LevelScene::update(Game &, Ogre::FrameEvent const &)
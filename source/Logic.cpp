@@ -1,6 +1,7 @@
 #include <OgreParticleSystem.h>
 #include <algorithm>
 #include <iostream>
+#include <cstdlib>
 #include "UIOverlaySelection.hpp"
 #include "Logic.hpp"
 #include "Physics.hpp"
@@ -8,6 +9,7 @@
 #include "Player.hpp"
 #include "Enemy.hpp"
 #include "AudioListener.hpp"
+#include "LevelPipeline.hpp"
 
 // TODO: extract as mush as possible to gameState.
 // Logic could be passed as ref for spawning and & so on.
@@ -16,6 +18,9 @@ bool Logic::tick()
   std::lock_guard<std::mutex> const lock_guard(lock);
 
   ++updatesSinceLastFrame;
+  if (endless)
+    streamChunks();
+  influenceMap.nextTick();
 
   auto const updateElements([this](auto &elements)
 			    {
@@ -44,15 +49,24 @@ bool Logic::tick()
 		    (dropSeed <= 6) ? ProjectileType::GOLD5 :
 		    (dropSeed <= 10) ? ProjectileType::HEAL :  ProjectileType::GOLD);
 
-	  enemyProjectiles.add([this, drop](){
+	  pickups.add([this, drop](){
 	      return entityFactory.spawnProjectile(drop);
 	    }, enemy.pos, Vect<2u, double>{0.0, 0.0}, drop, 0.5);
+	  pickupGrid.insert(gameState.pickups.back().pos, gameState.pickups.back().radius,
+			    (unsigned int)gameState.pickups.size() - 1u);
+	  gameState.terrain.updateMembers(gameState.pickups, &Terrain::Room::pickups,
+					  (unsigned int)gameState.pickups.size() - 1u);
 	}
     }
   updateElements(gameState.players);
+  gameState.terrain.updateMembers(gameState.players, &Terrain::Room::players);
+  influenceMap.update(gameState.players, InfluenceMap::PLAYER_THREAT, [](auto const &player)
+		      {
+			return !player.isDead();
+		      });
   for (auto &player : gameState.players)
     {
-      auto &room(gameState.terrain.getRoom(Vect<2u, unsigned int>(player.pos)));
+      auto &room(gameState.terrain.getRooms()[player.roomId]);
 
       player.checkSpells(*this);
       if (!room.mobsSpawned)
@@ -67,20 +81,21 @@ bool Logic::tick()
 	  projectile.update(*this);
 	  gameState.terrain.correctFixture(projectile,
 					   [this](auto &projectile, Vect<2u, double> dir) {
-					     projectileList[projectile.type].wallResponse(projectile, dir);
+					     projectileList.wallResponse(projectile, dir);
 					   });
-	  if (projectile.type == ProjectileType::EXPLOSION)
-	    particleSpawns.emplace_back(projectile.pos, "explosion");
-	  else if (projectile.type == ProjectileType::HIT1
-		   || ((projectile.type == ProjectileType::ARROW
-			|| projectile.type == ProjectileType::BOUNCY_ARROW
-			|| projectile.type == ProjectileType::ICE_PILLAR)
-		       ))
-	    particleSpawns.emplace_back(projectile.pos, "blu");
 	}
     });
   updateProjectile(gameState.projectiles);
   updateProjectile(gameState.enemyProjectiles);
+  // Before removals, so removed entities leave their cell.
+  influenceMap.update(gameState.projectiles, InfluenceMap::PROJECTILE_DANGER, [](auto const &projectile)
+		      {
+			return !projectile.shouldBeRemoved();
+		      });
+  influenceMap.update(gameState.enemies, InfluenceMap::ENEMY_DENSITY, [](auto const &enemy)
+		      {
+			return !enemy.isDead();
+		      });
   projectiles.removeIf([](auto const &projectile)
 		       {
 			 return projectile.shouldBeRemoved();
@@ -89,31 +104,76 @@ bool Logic::tick()
 			    {
 			      return projectile.shouldBeRemoved();
 			    });
-  enemies.removeIf([](auto const &projectile)
-		   {
-		     return projectile.shouldBeRemoved();
-		   });
-  Physics::collisionTest(gameState.players.begin(), gameState.players.end(),
-			 gameState.enemies.begin(), gameState.enemies.end(),
-			 [](auto &player, auto &enemy){
-			   player.knockback((player.pos - enemy.pos).normalized() * 0.15, 5);
-			   player.takeDamage(30);
-			 });
-  Physics::collisionTest(gameState.projectiles.begin(), gameState.projectiles.end(),
-			 gameState.enemies.begin(), gameState.enemies.end(),
-			 [this](auto &projectile, auto &enemy){
-			   projectileList[projectile.type].hitEnemy(enemy, projectile);
-			 });
-  Physics::collisionTest(gameState.enemyProjectiles.begin(), gameState.enemyProjectiles.end(),
-			 gameState.players.begin(), gameState.players.end(),
-			 [this](auto &enemyProjectile, auto &player){
-			   if (enemyProjectile.type == ProjectileType::COOLDOWN_RESET)
-			     player.resetCooldowns();
-			   else if (enemyProjectile.type >= ProjectileType::GOLD
-				    && enemyProjectile.type <= ProjectileType::GOLD50)
-			     player.addGold(Vect<4u, unsigned int>(1u, 5u, 20u, 50u)[enemyProjectile.type - ProjectileType::GOLD]);
-			   projectileList[enemyProjectile.type].hitEnemy(player, enemyProjectile);
-			 });
+  // Removals shift indexes, room lists are then rebuilt.
+  if (std::any_of(gameState.enemies.begin(), gameState.enemies.end(), [](auto const &enemy)
+		  {
+		    return enemy.shouldBeRemoved();
+		  }))
+    {
+      enemies.removeIf([](auto const &enemy)
+		       {
+			 return enemy.shouldBeRemoved();
+		       });
+      gameState.terrain.rebuildMembers(gameState.enemies, &Terrain::Room::enemies);
+    }
+  else
+    gameState.terrain.updateMembers(gameState.enemies, &Terrain::Room::enemies);
+  // Pickups don't move, indexes only change when some are taken.
+  if (std::any_of(gameState.pickups.begin(), gameState.pickups.end(), [](auto const &pickup)
+		  {
+		    return pickup.shouldBeRemoved();
+		  }))
+    {
+      pickups.removeIf([](auto const &pickup)
+		       {
+			 return pickup.shouldBeRemoved();
+		       });
+      pickupGrid.rebuild(gameState.pickups);
+      gameState.terrain.rebuildMembers(gameState.pickups, &Terrain::Room::pickups);
+    }
+  // Overlap corrections move bodies, the margin keeps the pairs they push together.
+  // Bodies pushed further within one tick are separated on the next one.
+  constexpr double const CORRECTION_MARGIN{0.25};
+
+  broadphase.clear();
+  broadphase.insertAll(gameState.players, CORRECTION_MARGIN);
+  broadphase.insertAll(gameState.enemies, CORRECTION_MARGIN);
+  broadphase.insertAll(gameState.projectiles);
+  broadphase.insertAll(gameState.enemyProjectiles);
+  broadphase.collectPairs(workerPool);
+  Physics::pairTest(broadphase.getPairs(Collision::PLAYER, Collision::ENEMY),
+		    gameState.players, gameState.enemies,
+		    [](auto &player, auto &enemy){
+		      player.knockback((player.pos - enemy.pos).normalized() * 0.15, 5);
+		      player.takeDamage(30);
+		    });
+  // Projectile first: which projectile reaches an enemy first decides who gets through its invulnerability.
+  Physics::resizingPairTest(broadphase.getPairs(Collision::PLAYER_PROJECTILE, Collision::ENEMY),
+			    gameState.projectiles, gameState.enemies,
+			    [this](auto &projectile, auto &enemy){
+			      projectileList.hitEnemy(enemy, projectile);
+			    });
+  Physics::pairTest(broadphase.getPairs(Collision::PLAYER, Collision::ENEMY_PROJECTILE),
+		    gameState.players, gameState.enemyProjectiles,
+		    [this](auto &player, auto &enemyProjectile){
+		      projectileList.hitEnemy(player, enemyProjectile);
+		    });
+  for (auto &player : gameState.players)
+    if (player.doCollision())
+      pickupGrid.query(player.pos, player.radius, [this, &player](unsigned int item)
+		       {
+			 Projectile &pickup(gameState.pickups[item]);
+
+			 if (pickup.shouldBeRemoved()
+			     || !Physics::circleTest(player.pos, player.radius, pickup.pos, pickup.radius))
+			   return ;
+			 if (pickup.type == ProjectileType::COOLDOWN_RESET)
+			   player.resetCooldowns();
+			 else if (pickup.type >= ProjectileType::GOLD
+				  && pickup.type <= ProjectileType::GOLD50)
+			   player.addGold(Vect<4u, unsigned int>(1u, 5u, 20u, 50u)[pickup.type - ProjectileType::GOLD]);
+			 projectileList.hitEnemy(player, pickup);
+		       });
   constexpr auto const correctOverlap([](auto &a, auto &b){
       auto const center((a.pos + b.pos) * 0.5);
       auto const overlap((a.pos - b.pos).normalized() * (a.radius + b.radius));
@@ -121,15 +181,23 @@ bool Logic::tick()
       a.pos = center + overlap * 0.5;
       b.pos = center - overlap * 0.5;
     });
-  Physics::collisionTest(gameState.players.begin(), gameState.players.end(), correctOverlap);
-  Physics::collisionTest(gameState.enemies.begin(), gameState.enemies.end(), correctOverlap);
-  for (auto &enemy : gameState.enemies)
+  Physics::pairTest(broadphase.getPairs(Collision::PLAYER, Collision::PLAYER),
+		    gameState.players, gameState.players, correctOverlap);
+  Physics::pairTest(broadphase.getPairs(Collision::ENEMY, Collision::ENEMY),
+		    gameState.enemies, gameState.enemies, correctOverlap);
+  pyEvaluate.updateVisibility();
+  pyEvaluate.updateFlowField();
+  for (unsigned int i(0u); i != gameState.enemies.size(); ++i)
   {
+    Enemy &enemy(gameState.enemies[i]);
+
     if (enemy.ai)
     {
+      pyEvaluate.currentEnemy = i;
       pyBindInstance.execAI[enemy.ai](&pyBindInstance, enemy, pyEvaluate);
     }
   }
+  pyEvaluate.currentEnemy = PyEvaluate::NO_ENEMY;
   for (auto &player : gameState.players)
   {
     unsigned int ai(player.getAI());
@@ -150,8 +218,15 @@ Logic::Logic(LevelScene &levelScene, Renderer &renderer, std::vector<AnimatedEnt
   , enemies(gameState.enemies, levelScene.enemies)
   , projectiles(gameState.projectiles, levelScene.projectiles)
   , enemyProjectiles(gameState.enemyProjectiles, levelScene.enemyProjectiles)
+  , pickups(gameState.pickups, levelScene.pickups)
+  , pickupGrid()
+  , influenceMap()
+  , pickupAngle(0.0)
+  , endless(isEndless())
+  , chunkStreamer()
+  , terrainShift{0, 0}
   , entityFactory(renderer)
-  , pyEvaluate(gameState.players, gameState.enemies, gameState.terrain)
+  , pyEvaluate(gameState.players, gameState.enemies, gameState.pickups, gameState.terrain, influenceMap)
   , projectileList{}
   , spellList{}
   , randEngine(42u)
@@ -185,9 +260,33 @@ Logic::Logic(LevelScene &levelScene, Renderer &renderer, std::vector<AnimatedEnt
       {KBACTION::MOUNT, OIS::KC_DOWN}}}
 #endif // defined OIS_WIN32_PLATFORM
 {
-  gameState.terrain.generateLevel(420u); // TODO: something better
+  Vect<2u, double> start{8.0, 8.0};
+  std::vector<TerrainMesher::ChunkMesh> meshes;
+
+  if (endless)
+    {
+      gameState.terrain.startEndless(LevelPipeline::FIRST_LEVEL, {ChunkStreamer::WINDOW_CHUNKS, ChunkStreamer::WINDOW_CHUNKS});
+
+      Terrain::Room &room(gameState.terrain.getRooms()[gameState.terrain.getChunkRoom({ChunkStreamer::WINDOW_CHUNKS / 2u,
+		ChunkStreamer::WINDOW_CHUNKS / 2u})]);
+
+      // Like a generated level's first room, the starting one has no mobs.
+      room.mobsSpawned = true;
+      start = room.pos;
+      meshes = TerrainMesher::meshTerrain(gameState.terrain);
+    }
+  else
+    {
+      LevelPipeline::Level level(LevelPipeline::getPipeline().take(LevelPipeline::FIRST_LEVEL));
+
+      gameState.terrain = std::move(level.terrain);
+      meshes = std::move(level.meshes);
+      // Ready for the next game.
+      LevelPipeline::getPipeline().prefetch(LevelPipeline::FIRST_LEVEL);
+    }
+  influenceMap.resize(gameState.terrain.getSize());
   for (size_t i = 0; i < vec.size(); i++) {
-    gameState.players.push_back(Player::makePlayer(Vect<2u, double>{(double)i + 8.0, (double)(i % 2) + 8.0}, vec[i]));
+    gameState.players.push_back(Player::makePlayer(start + Vect<2u, double>{(double)i, (double)(i % 2)}, vec[i]));
   }
   size_t kb = 0;
   size_t js = 0;
@@ -224,7 +323,7 @@ Logic::Logic(LevelScene &levelScene, Renderer &renderer, std::vector<AnimatedEnt
       }
     }
   }
-  levelScene.setTerrain(gameState.terrain);
+  levelScene.setTerrain(gameState.terrain, meshes);
 }
 
 void Logic::spawnMobGroup(Terrain::Room &room)
@@ -237,6 +336,69 @@ void Logic::spawnMobGroup(Terrain::Room &room)
       }, AI::CHASEPLAYER, 100u * gameState.players.size(), 0.5, room.pos + Vect<2u, double>{0., (double)i * 0.1});
 }
 
+void Logic::streamChunks()
+{
+  Terrain &terrain(gameState.terrain);
+  Vect<2u, int> const delta(ChunkStreamer::windowShift(terrain, gameState.players));
+
+  if (!delta[0] && !delta[1])
+    return ;
+
+  // The next window is started on the level pipeline's thread, the window only moves once it is ready.
+  Vect<2u, long> const origin(terrain.getOrigin() + Vect<2u, long>(delta));
+  Terrain next;
+
+  if (!LevelPipeline::getPipeline().takeWindow(origin, next))
+    {
+      LevelPipeline::getPipeline().prefetchWindow(terrain, origin);
+      return ;
+    }
+
+  Vect<2u, double> const offset((double)delta[0] * Terrain::CHUNK_SIZE, (double)delta[1] * Terrain::CHUNK_SIZE);
+  auto const leaves([&terrain, delta](auto const &element)
+		    {
+		      return ChunkStreamer::leaves(terrain, delta, element.pos);
+		    });
+  auto const follow([offset](auto &elements)
+		    {
+		      for (auto &element : elements)
+			element.pos -= offset;
+		    });
+
+  std::clog << "[Logic] Moving the terrain window by " << delta << std::endl;
+  chunkStreamer.archive(terrain, delta, gameState.enemies);
+  enemies.removeIf(leaves);
+  projectiles.removeIf(leaves);
+  enemyProjectiles.removeIf(leaves);
+  pickups.removeIf(leaves);
+  terrain.shiftWindow(std::move(next));
+  influenceMap.shift(delta * (int)Terrain::CHUNK_SIZE);
+  follow(gameState.players);
+  follow(gameState.enemies);
+  follow(gameState.projectiles);
+  follow(gameState.enemyProjectiles);
+  follow(gameState.pickups);
+  for (auto &spawn : particleSpawns)
+    spawn.first -= offset;
+  chunkStreamer.restore(terrain, delta, [this](ChunkStreamer::PackedEnemy const &enemy, Vect<2u, double> pos)
+			{
+			  enemies.add([this](){
+			      return entityFactory.spawnEnemy();
+			    }, (unsigned int)enemy.ai, (unsigned int)enemy.maxHealth, 0.5, pos);
+			  gameState.enemies.back().setHealth(enemy.health);
+			});
+
+  // Everything indexed by position or room is rebuilt.
+  terrain.rebuildMembers(gameState.players, &Terrain::Room::players);
+  terrain.rebuildMembers(gameState.enemies, &Terrain::Room::enemies);
+  terrain.rebuildMembers(gameState.pickups, &Terrain::Room::pickups);
+  pickupGrid.rebuild(gameState.pickups);
+  influenceMap.follow(gameState.players);
+  influenceMap.follow(gameState.enemies);
+  influenceMap.follow(gameState.projectiles);
+  terrainShift += delta;
+}
+
 void Logic::spawnProjectile(Vect<2u, double> pos, Vect<2u, double> speed, unsigned int type, double size, unsigned int timeLeft)
 {
   projectiles.add([this](){
@@ -244,6 +406,15 @@ void Logic::spawnProjectile(Vect<2u, double> pos, Vect<2u, double> speed, unsign
     }, pos, speed, type, size, timeLeft);
 }
 
+void Logic::spawnEnemyProjectile(Vect<2u, double> pos, Vect<2u, double> speed, unsigned int type, double size, unsigned int timeLeft)
+{
+  enemyProjectiles.add([this](){
+      return entityFactory.spawnOgreHead();
+    }, pos, speed, type, size, timeLeft);
+  gameState.enemyProjectiles.back().category = Collision::ENEMY_PROJECTILE;
+  gameState.enemyProjectiles.back().mask = Collision::defaultMask(Collision::ENEMY_PROJECTILE);
+}
+
 void Logic::run()
 {
   constexpr std::chrono::microseconds TICK_TIME{1000000 / 120};
@@ -278,42 +449,53 @@ void Logic::updateDisplay(LevelScene &levelScene)
 {
   std::lock_guard<std::mutex> const lock_guard(lock);
 
+  if (terrainShift[0] || terrainShift[1])
+    {
+      levelScene.shiftTerrain(gameState.terrain, terrainShift);
+      particlePool.shift(Ogre::Vector3(-static_cast<Ogre::Real>(terrainShift[0] * (int)Terrain::CHUNK_SIZE), 0.0f,
+				       -static_cast<Ogre::Real>(terrainShift[1] * (int)Terrain::CHUNK_SIZE)));
+      terrainShift = {0, 0};
+    }
   enemies.updateTarget();
-  auto const updateProjectileEntities([this, &levelScene](auto &projectiles){
+  // Instance transforms are written straight from the simulation, no scene node involved.
+  auto const updateProjectileEntities([this](auto &projectiles){
       projectiles.updateTarget();
-      projectiles.forEach([this](Entity &entity, Projectile &projectile)
+      projectiles.forEach([this](Instance &instance, Projectile &projectile)
 			  {
 			    double angle(projectile.timeLeft * 0.01);
-
-			    if (projectile.doSpin())
-			      entity.setDirection(Vect<2u, Ogre::Real>((Ogre::Real)std::cos(angle), (Ogre::Real)std::sin(angle)));
-			    entity.setPosition(static_cast<Ogre::Real>(projectile.pos[0]), 0.f, static_cast<Ogre::Real>(projectile.pos[1]));
+			    Ogre::Vector3 const pos(static_cast<Ogre::Real>(projectile.pos[0]), 0.f, static_cast<Ogre::Real>(projectile.pos[1]));
+			    char const *trail(particleTrail(projectile.type));
+
+			    instance.setTransform(pos, projectile.doSpin() ?
+						  Instance::directionToOrientation((Ogre::Real)std::cos(angle), (Ogre::Real)std::sin(angle)) :
+						  Ogre::Quaternion::IDENTITY);
+			    if (projectile.trail != ParticlePool::NO_TRAIL)
+			      particlePool.moveTrail(projectile.trail, pos);
+			    else if (trail)
+			      projectile.trail = particlePool.startTrail(entityFactory, trail, pos);
 			  });
     });
   updateProjectileEntities(projectiles);
   updateProjectileEntities(enemyProjectiles);
 
+  // Every pickup spins the same way, they all share one direction.
+  pickupAngle -= updatesSinceLastFrame * 0.01;
+  pickups.updateTarget();
+  Ogre::Quaternion const pickupOrientation(Instance::directionToOrientation((Ogre::Real)std::cos(pickupAngle),
+									    (Ogre::Real)std::sin(pickupAngle)));
+
+  pickups.forEach([&pickupOrientation](Instance &instance, Projectile &pickup)
+		  {
+		    instance.setTransform(Ogre::Vector3(static_cast<Ogre::Real>(pickup.pos[0]), 0.f, static_cast<Ogre::Real>(pickup.pos[1])),
+					  pickupOrientation);
+		  });
+  entityFactory.updatePool();
+
   for (auto &&pair : particleSpawns)
-    {
-      particleEffects.emplace_back(30, entityFactory.createParticleSystem(pair.second));
-      particleEffects.back().second.setPosition(static_cast<Ogre::Real>(pair.first[0]), 0.f, static_cast<Ogre::Real>(pair.first[1]));	
-    }
+    particlePool.spawn(entityFactory, pair.second,
+		       Ogre::Vector3(static_cast<Ogre::Real>(pair.first[0]), 0.f, static_cast<Ogre::Real>(pair.first[1])));
   particleSpawns.clear();
-  for (auto &effect : particleEffects)
-    {
-      if (effect.first > updatesSinceLastFrame)
-	effect.first -= updatesSinceLastFrame;
-      else
-	effect.first = 0;
-      if (effect.first < 10)
-	effect.second.getOgre()->setEmitting(false);
-      // if (!effect.first)
-      // 	effect.second = ParticleEffect{}; // Pre-erase just in case.
-    }
-  particleEffects.erase(std::remove_if(particleEffects.begin(), particleEffects.end(), [](auto const &p)
-				       {
-					 return !p.first;
-				       }), particleEffects.end());
+  particlePool.update(updatesSinceLastFrame);
 
 
   auto const updateControllableEntity([](AnimatedEntity &animatedEntity, Controllable &controllable){
@@ -462,6 +644,27 @@ void Logic::updateDisplay(LevelScene &levelScene)
   updatesSinceLastFrame = 0;
 }
 
+bool Logic::isEndless()
+{
+  return !!std::getenv("SSK_ENDLESS");
+}
+
+char const *Logic::particleTrail(unsigned int projectileType)
+{
+  switch (projectileType)
+    {
+    case ProjectileType::EXPLOSION:
+      return "explosion";
+    case ProjectileType::ARROW:
+    case ProjectileType::BOUNCY_ARROW:
+    case ProjectileType::ICE_PILLAR:
+    case ProjectileType::HIT1:
+      return "blu";
+    default:
+      return nullptr;
+    }
+}
+
 void Logic::calculateCamera(LevelScene &levelScene)
 {
   constexpr double const angle(180 - 60 / 2);
@@ -506,6 +709,7 @@ void Logic::calculateCamera(LevelScene &levelScene)
   levelScene.cameraNode->setPosition((Ogre::Real)cameraDest[0],
 				     (Ogre::Real)cameraDest[1],
 				     (Ogre::Real)cameraDest[2]);
+  levelScene.updateTerrainVisibility();
 
   AudioListener::setPos(levelScene.cameraNode->getPosition());
 }
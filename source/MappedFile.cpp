@@ -0,0 +1,82 @@
+#include <stdexcept>
+#include "MappedFile.hpp"
+
+#if defined _WIN32
+# include <fstream>
+# include <iterator>
+#else
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+#endif
+
+#if defined _WIN32
+
+MappedFile::MappedFile(std::string const &path)
+  : data(nullptr)
+  , size(0u)
+  , buffer()
+{
+  std::ifstream file(path, std::ios::binary);
+
+  if (!file)
+    throw std::runtime_error("Failed to open " + path);
+  buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  data = buffer.data();
+  size = buffer.size();
+}
+
+MappedFile::~MappedFile()
+{
+}
+
+#else
+
+MappedFile::MappedFile(std::string const &path)
+  : data(nullptr)
+  , size(0u)
+{
+  int const fd(open(path.c_str(), O_RDONLY));
+  struct stat info;
+
+  if (fd < 0)
+    throw std::runtime_error("Failed to open " + path);
+  if (fstat(fd, &info) < 0)
+    {
+      close(fd);
+      throw std::runtime_error("Failed to stat " + path);
+    }
+  size = (std::size_t)info.st_size;
+  if (size)
+    {
+      void *mapped(mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0));
+
+      if (mapped == MAP_FAILED)
+	{
+	  close(fd);
+	  throw std::runtime_error("Failed to map " + path);
+	}
+      data = static_cast<char const *>(mapped);
+    }
+  // The mapping stays valid once the descriptor is closed.
+  close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+  if (data)
+    munmap(const_cast<char *>(data), size);
+}
+
+#endif
+
+char const *MappedFile::getData() const
+{
+  return data;
+}
+
+std::size_t MappedFile::getSize() const
+{
+  return size;
+}
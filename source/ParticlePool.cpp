@@ -0,0 +1,182 @@
+#include <iostream>
+#include <algorithm>
+#include <OgreParticle.h>
+#include "ParticlePool.hpp"
+#include "EntityFactory.hpp"
+
+constexpr unsigned int const ParticlePool::LIFETIME;
+constexpr unsigned int const ParticlePool::FADE_TICKS;
+constexpr unsigned int const ParticlePool::CAP;
+constexpr unsigned int const ParticlePool::COALESCE_TICKS;
+constexpr float const ParticlePool::COALESCE_RADIUS;
+constexpr unsigned int const ParticlePool::FRAME_BUDGET;
+constexpr unsigned int const ParticlePool::NO_TRAIL;
+
+ParticlePool::ParticlePool()
+  : templates()
+  , templateIds()
+  , started(0ul)
+  , tick(0ul)
+  , budget(FRAME_BUDGET)
+  , coalesced(0ul)
+  , dropped(0ul)
+{
+}
+
+ParticlePool::~ParticlePool()
+{
+  std::clog << "[Particles] " << started << " effects started, " << coalesced << " coalesced, "
+	    << dropped << " dropped" << std::endl;
+}
+
+unsigned int ParticlePool::getTemplate(std::string const &temp)
+{
+  auto const found(templateIds.find(temp));
+
+  if (found != templateIds.end())
+    return found->second;
+  templates.push_back(Template{temp, {}, {}});
+  templateIds.emplace(temp, (unsigned int)templates.size() - 1u);
+  return (unsigned int)templates.size() - 1u;
+}
+
+unsigned int ParticlePool::acquire(EntityFactory &entityFactory, Template &pool)
+{
+  if (!pool.free.empty())
+    {
+      unsigned int const index(pool.free.back());
+      Ogre::SceneNode *node(pool.slots[index].effect.getNode());
+
+      pool.free.pop_back();
+      node->getCreator()->getRootSceneNode()->addChild(node);
+      return index;
+    }
+  if (pool.slots.size() < CAP)
+    {
+      pool.slots.push_back(Slot{entityFactory.createParticleSystem(pool.name), 0u, 0ul, 0ul, false, false});
+      return (unsigned int)pool.slots.size() - 1u;
+    }
+
+  unsigned int oldest(CAP);
+
+  for (unsigned int i(0u); i != pool.slots.size(); ++i)
+    if (!pool.slots[i].trail && (oldest == CAP || pool.slots[i].started < pool.slots[oldest].started))
+      oldest = i;
+  if (oldest != CAP)
+    pool.slots[oldest].effect.getOgre()->clear();
+  return oldest;
+}
+
+void ParticlePool::start(Slot &slot, Ogre::Vector3 pos, bool trail)
+{
+  slot.effect.getOgre()->setEmitting(true);
+  slot.effect.setPosition(pos);
+  slot.ticksLeft = LIFETIME;
+  slot.started = ++started;
+  slot.startTick = tick;
+  slot.trail = trail;
+  slot.seen = trail;
+  --budget;
+}
+
+void ParticlePool::stop(Slot &slot)
+{
+  Ogre::SceneNode *node(slot.effect.getNode());
+
+  slot.effect.getOgre()->setEmitting(false);
+  slot.effect.getOgre()->clear();
+  if (node->getParentSceneNode())
+    node->getParentSceneNode()->removeChild(node);
+  slot.ticksLeft = 0u;
+}
+
+void ParticlePool::spawn(EntityFactory &entityFactory, std::string const &temp, Ogre::Vector3 pos)
+{
+  Template &pool(templates[getTemplate(temp)]);
+
+  for (Slot const &slot : pool.slots)
+    if (slot.ticksLeft && !slot.trail && tick - slot.startTick < COALESCE_TICKS
+	&& slot.effect.getNode()->getPosition().squaredDistance(pos) < COALESCE_RADIUS * COALESCE_RADIUS)
+      {
+	++coalesced;
+	return ;
+      }
+
+  unsigned int const index(budget ? acquire(entityFactory, pool) : CAP);
+
+  if (index == CAP)
+    {
+      ++dropped;
+      return ;
+    }
+  start(pool.slots[index], pos, false);
+}
+
+unsigned int ParticlePool::startTrail(EntityFactory &entityFactory, std::string const &temp, Ogre::Vector3 pos)
+{
+  unsigned int const id(getTemplate(temp));
+  unsigned int const index(budget ? acquire(entityFactory, templates[id]) : CAP);
+
+  if (index == CAP)
+    return NO_TRAIL;
+  start(templates[id].slots[index], pos, true);
+  return id * CAP + index;
+}
+
+void ParticlePool::moveTrail(unsigned int trail, Ogre::Vector3 pos)
+{
+  Slot &slot(templates[trail / CAP].slots[trail % CAP]);
+
+  slot.effect.setPosition(pos);
+  slot.seen = true;
+}
+
+void ParticlePool::shift(Ogre::Vector3 offset)
+{
+  for (Template &pool : templates)
+    for (Slot &slot : pool.slots)
+      if (slot.ticksLeft || slot.trail)
+	{
+	  Ogre::ParticleSystem *system(slot.effect.getOgre());
+
+	  slot.effect.getNode()->translate(offset);
+	  // Particles live in world space, moving the node only moves the emitters.
+	  for (std::size_t i(0u); i != system->getNumParticles(); ++i)
+	    system->getParticle(i)->position += offset;
+	}
+}
+
+void ParticlePool::update(unsigned int ticks)
+{
+  tick += ticks;
+  for (Template &pool : templates)
+    for (unsigned int i(0u); i != pool.slots.size(); ++i)
+      {
+	Slot &slot(pool.slots[i]);
+
+	if (slot.trail)
+	  {
+	    if (slot.seen)
+	      {
+		slot.seen = false;
+		continue ;
+	      }
+	    // Its entity is gone, the trail fades as a one shot effect would.
+	    slot.trail = false;
+	    slot.ticksLeft = FADE_TICKS;
+	    slot.effect.getOgre()->setEmitting(false);
+	    continue ;
+	  }
+	if (!slot.ticksLeft)
+	  continue ;
+	slot.ticksLeft -= std::min(slot.ticksLeft, ticks);
+	if (!slot.ticksLeft)
+	  {
+	    stop(slot);
+	    pool.free.push_back(i);
+	  }
+	else if (slot.ticksLeft < FADE_TICKS)
+	  slot.effect.getOgre()->setEmitting(false);
+      }
+  budget = FRAME_BUDGET;
+}
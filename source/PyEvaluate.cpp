@@ -1,9 +1,13 @@
+#include <cmath>
 #include <algorithm>
 #include "PyEvaluate.hpp"
 
+constexpr unsigned int const PyEvaluate::NO_ENEMY;
+
 PyEvaluate::PyEvaluate(std::vector<Player> &players,
-    std::vector<Enemy> &enemies, Terrain &terrain)
-: players(players), enemies(enemies), terrain(terrain), attack(false)
+    std::vector<Enemy> &enemies, std::vector<Projectile> &pickups, Terrain &terrain,
+    InfluenceMap const &influenceMap)
+: players(players), enemies(enemies), pickups(pickups), terrain(terrain), influenceMap(influenceMap), attack(false), currentEnemy(NO_ENEMY), rays(), flowField(), playerTiles()
 {
 }
 
@@ -40,6 +44,117 @@ Vect<2u, double> PyEvaluate::furtherPlayer(Vect<2u, double> pos) const
   return (it == players.end() ? pos : (*it).pos);
 }
 
+bool PyEvaluate::lineOfSight(Vect<2u, double> a, Vect<2u, double> b) const
+{
+  return terrain.lineOfSight(a, b);
+}
+
+Terrain::Room const &PyEvaluate::roomAt(Vect<2u, double> pos) const
+{
+  return terrain.getRooms()[terrain.getRoomId(Vect<2u, unsigned int>(pos))];
+}
+
+unsigned int PyEvaluate::playersInRoom(Vect<2u, double> pos) const
+{
+  auto const &members(roomAt(pos).players);
+
+  return (unsigned int)std::count_if(members.begin(), members.end(), [this](unsigned int i)
+				     {
+				       return !players[i].isDead();
+				     });
+}
+
+unsigned int PyEvaluate::enemiesInRoom(Vect<2u, double> pos) const
+{
+  auto const &members(roomAt(pos).enemies);
+
+  return (unsigned int)std::count_if(members.begin(), members.end(), [this](unsigned int i)
+				     {
+				       return !enemies[i].isDead();
+				     });
+}
+
+Vect<2u, double> PyEvaluate::closestEnemyInRoom(Vect<2u, double> pos) const
+{
+  return closestInRoom(pos, enemies, &Terrain::Room::enemies);
+}
+
+Vect<2u, double> PyEvaluate::closestPickupInRoom(Vect<2u, double> pos) const
+{
+  return closestInRoom(pos, pickups, &Terrain::Room::pickups);
+}
+
+float PyEvaluate::playerThreat(Vect<2u, double> pos) const
+{
+  return influenceMap.get(InfluenceMap::PLAYER_THREAT, pos);
+}
+
+float PyEvaluate::enemyDensity(Vect<2u, double> pos) const
+{
+  return influenceMap.get(InfluenceMap::ENEMY_DENSITY, pos);
+}
+
+float PyEvaluate::projectileDanger(Vect<2u, double> pos) const
+{
+  return influenceMap.get(InfluenceMap::PROJECTILE_DANGER, pos);
+}
+
+Vect<2u, double> PyEvaluate::safestCell(Vect<2u, double> pos) const
+{
+  return influenceMap.lowest(InfluenceMap::PROJECTILE_DANGER, pos);
+}
+
+void PyEvaluate::updateVisibility()
+{
+  rays.clear();
+  for (Enemy const &enemy : enemies)
+    rays.add(enemy.pos, closestPlayer(enemy.pos));
+  terrain.raycast(rays);
+}
+
+bool PyEvaluate::enemySeesClosestPlayer(unsigned int enemy) const
+{
+  if (rays.size() == enemies.size())
+    return !rays.hit[enemy];
+  return lineOfSight(enemies[enemy].pos, closestPlayer(enemies[enemy].pos));
+}
+
+bool PyEvaluate::seesClosestPlayer(Controllable const &controllable) const
+{
+  if (currentEnemy < enemies.size() && &enemies[currentEnemy] == &controllable)
+    return enemySeesClosestPlayer(currentEnemy);
+  return lineOfSight(controllable.pos, closestPlayer(controllable.pos));
+}
+
+void PyEvaluate::updateFlowField()
+{
+  playerTiles.clear();
+  for (Player const &player : players)
+    if (!player.isDead())
+      playerTiles.emplace_back(player.pos);
+  flowField.update(terrain, playerTiles);
+}
+
+Vect<2u, double> PyEvaluate::flowDirection(Vect<2u, double> pos) const
+{
+  Vect<2u, int> const tile((int)std::floor(pos[0]), (int)std::floor(pos[1]));
+  Vect<2u, int> const direction(flowField.getDirection(tile));
+
+  if (direction.equals({0, 0}))
+    return {0.0, 0.0};
+  return (Vect<2u, double>(tile + direction) + Vect<2u, double>{0.5, 0.5} - pos).normalized();
+}
+
+Vect<2u, double> PyEvaluate::pathTowards(Vect<2u, double> from, Vect<2u, double> to)
+{
+  Vect<2u, unsigned int> const tile(from);
+  Vect<2u, unsigned int> const step(terrain.getRoomGraph().nextStep(terrain, tile, Vect<2u, unsigned int>(to)));
+
+  if (step.equals(tile))
+    return {0.0, 0.0};
+  return (Vect<2u, double>(step) + Vect<2u, double>{0.5, 0.5} - from).normalized();
+}
+
 Vect<2u, double> PyEvaluate::followRightWall(Vect<2u, double> pos) const
 {
   bool walls[9];
@@ -47,8 +162,8 @@ Vect<2u, double> PyEvaluate::followRightWall(Vect<2u, double> pos) const
 
   for (int i(0), j(0); j < 3; i++)
   {
-    walls[i + 3 * j] = terrain.getTile(pos +
-        Vect<2u, double>{static_cast<double>(i - 1), static_cast<double>(j - 1)}).isSolid;
+    walls[i + 3 * j] = terrain.isSolid(pos +
+        Vect<2u, double>{static_cast<double>(i - 1), static_cast<double>(j - 1)});
     if (i == 2)
     {
         i = -1;
@@ -0,0 +1,390 @@
+#include <array>
+#include <queue>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <functional>
+#include "RoomGraph.hpp"
+#include "Terrain.hpp"
+
+constexpr unsigned int const RoomGraph::LOCAL_SEARCH_LIMIT;
+
+constexpr unsigned int const RoomGraph::NO_REGION;
+constexpr unsigned int const RoomGraph::CLUSTER_SIZE;
+constexpr unsigned int const RoomGraph::CACHED_PAIRS;
+
+RoomGraph::RoomGraph()
+  : chunkCount{0u, 0u}
+  , regions()
+  , centers()
+  , portals()
+  , nextPortal()
+  , costs()
+  , firstPortals()
+  , stamps()
+  , stamp(0u)
+{
+}
+
+unsigned int RoomGraph::getRegion(Vect<2u, unsigned int> tile) const
+{
+  Vect<2u, unsigned int> const chunk(tile[0] / Terrain::CHUNK_SIZE, tile[1] / Terrain::CHUNK_SIZE);
+
+  if (chunk[0] >= chunkCount[0] || chunk[1] >= chunkCount[1])
+    return NO_REGION;
+
+  auto const &plane(regions[chunk[0] + chunk[1] * chunkCount[0]]);
+
+  return plane.empty() ? NO_REGION : plane[tile[0] % Terrain::CHUNK_SIZE + (tile[1] % Terrain::CHUNK_SIZE) * Terrain::CHUNK_SIZE];
+}
+
+unsigned int RoomGraph::getRegionCount() const
+{
+  return (unsigned int)portals.size();
+}
+
+void RoomGraph::build(Terrain const &terrain)
+{
+  static_assert(!(Terrain::CHUNK_SIZE % CLUSTER_SIZE), "regions must not cross chunks");
+
+  chunkCount = terrain.getChunkCount();
+  regions.assign(chunkCount[0] * chunkCount[1], {});
+  centers.clear();
+  portals.clear();
+  nextPortal.clear();
+
+  // Regions are 4-connected tiles of one room and cluster, so each chunk is labelled alone:
+  // tiles join their left and upper neighbours in a union find whose roots are the first tiles in row order.
+  // Regions are then numbered in row order, like a flood fill started from each unvisited tile would.
+  std::vector<unsigned int> parents(Terrain::CHUNK_SIZE * Terrain::CHUNK_SIZE);
+  std::vector<Vect<2u, double>> sums;
+  std::vector<unsigned int> sizes;
+  std::array<std::uint64_t, Terrain::CHUNK_SIZE> solid;
+  auto const root([&parents](unsigned int tile)
+		  {
+		    while (parents[tile] != tile)
+		      tile = parents[tile] = parents[parents[tile]];
+		    return tile;
+		  });
+  auto const forEachFloor([&solid](auto &&func)
+			  {
+			    for (Vect<2u, unsigned int> i(0u, 0u); i[1] != Terrain::CHUNK_SIZE; ++i[1])
+			      if (~solid[i[1]])
+				for (i[0] = 0u; i[0] != Terrain::CHUNK_SIZE; ++i[0])
+				  if (!((solid[i[1]] >> i[0]) & 1u))
+				    func(i, i[0] + i[1] * Terrain::CHUNK_SIZE);
+			  });
+
+  for (Vect<2u, unsigned int> chunk(0u, 0u); chunk[1] != chunkCount[1]; ++chunk[1])
+    for (chunk[0] = 0u; chunk[0] != chunkCount[0]; ++chunk[0])
+      {
+	if (!terrain.hasChunk(chunk))
+	  continue ;
+
+	std::vector<unsigned int> &plane(regions[chunk[0] + chunk[1] * chunkCount[0]]);
+	Vect<2u, unsigned int> const corner(chunk * Terrain::CHUNK_SIZE);
+
+	plane.assign(Terrain::CHUNK_SIZE * Terrain::CHUNK_SIZE, NO_REGION);
+	for (unsigned int y(0u); y != Terrain::CHUNK_SIZE; ++y)
+	  solid[y] = terrain.getSolidRow((long)corner[0], (long)(corner[1] + y));
+	forEachFloor([&](Vect<2u, unsigned int> i, unsigned int tile)
+		     {
+		       unsigned int const room(terrain.getRoomId(corner + i));
+
+		       parents[tile] = tile;
+		       for (Vect<2u, unsigned int> const &previous : {Vect<2u, unsigned int>{1u, 0u}, Vect<2u, unsigned int>{0u, 1u}})
+			 if (i[0] % CLUSTER_SIZE >= previous[0] && i[1] % CLUSTER_SIZE >= previous[1]
+			     && !((solid[i[1] - previous[1]] >> (i[0] - previous[0])) & 1u)
+			     && terrain.getRoomId(corner + i - previous) == room)
+			   {
+			     unsigned int const a(root(tile));
+			     unsigned int const b(root(tile - previous[0] - previous[1] * Terrain::CHUNK_SIZE));
+
+			     parents[std::max(a, b)] = std::min(a, b);
+			   }
+		     });
+	forEachFloor([&](Vect<2u, unsigned int> i, unsigned int tile)
+		     {
+		       unsigned int const first(root(tile));
+
+		       if (first == tile)
+			 {
+			   plane[tile] = (unsigned int)sizes.size();
+			   sums.emplace_back(0.0, 0.0);
+			   sizes.push_back(0u);
+			 }
+		       else
+			 plane[tile] = plane[first];
+		       sums[plane[tile]] += Vect<2u, double>(corner + i);
+		       ++sizes[plane[tile]];
+		     });
+      }
+  for (unsigned int region(0u); region != sizes.size(); ++region)
+    centers.push_back(sums[region] / (double)sizes[region] + Vect<2u, double>{0.5, 0.5});
+  portals.resize(centers.size());
+  costs.resize(centers.size());
+  firstPortals.resize(centers.size());
+  stamps.assign(centers.size(), 0u);
+  stamp = 0u;
+
+  // Tiles of different regions next to each other, the first one being in the lower region.
+  struct Crossing
+  {
+    unsigned int region;
+    unsigned int other;
+    Vect<2u, unsigned int> from;
+    Vect<2u, unsigned int> to;
+  };
+
+  std::vector<Crossing> crossings;
+
+  for (Vect<2u, unsigned int> chunk(0u, 0u); chunk[1] != chunkCount[1]; ++chunk[1])
+    for (chunk[0] = 0u; chunk[0] != chunkCount[0]; ++chunk[0])
+      {
+	std::vector<unsigned int> const &plane(regions[chunk[0] + chunk[1] * chunkCount[0]]);
+	Vect<2u, unsigned int> const corner(chunk * Terrain::CHUNK_SIZE);
+
+	if (plane.empty())
+	  continue ;
+	for (Vect<2u, unsigned int> i(0u, 0u); i[1] != Terrain::CHUNK_SIZE; ++i[1])
+	  for (i[0] = 0u; i[0] != Terrain::CHUNK_SIZE; ++i[0])
+	    {
+	      unsigned int const region(plane[i[0] + i[1] * Terrain::CHUNK_SIZE]);
+
+	      if (region == NO_REGION)
+		continue ;
+	      for (Vect<2u, unsigned int> const &step : {Vect<2u, unsigned int>{1u, 0u}, Vect<2u, unsigned int>{0u, 1u}})
+		{
+		  Vect<2u, unsigned int> const next(i + step);
+		  unsigned int const nextRegion(next[0] < Terrain::CHUNK_SIZE && next[1] < Terrain::CHUNK_SIZE ?
+						plane[next[0] + next[1] * Terrain::CHUNK_SIZE] : getRegion(corner + next));
+
+		  if (nextRegion == NO_REGION || region == nextRegion)
+		    continue ;
+		  if (region < nextRegion)
+		    crossings.push_back(Crossing{region, nextRegion, corner + i, corner + next});
+		  else
+		    crossings.push_back(Crossing{nextRegion, region, corner + next, corner + i});
+		}
+	    }
+      }
+
+  // Per region, the later regions it touches: how many crossings, and the middle one.
+  struct Border
+  {
+    unsigned int region;
+    unsigned int count;
+    unsigned int seen;
+    Vect<2u, unsigned int> from;
+    Vect<2u, unsigned int> to;
+  };
+
+  std::vector<std::vector<Border>> borders(centers.size());
+  auto const borderOf([&borders](Crossing const &crossing) -> Border &
+		      {
+			// Regions only touch a few others, a linear search is enough.
+			for (Border &border : borders[crossing.region])
+			  if (border.region == crossing.other)
+			    return border;
+			borders[crossing.region].push_back(Border{crossing.other, 0u, 0u, {0u, 0u}, {0u, 0u}});
+			return borders[crossing.region].back();
+		      });
+
+  // Counted first, the second pass then knows which crossing is in the middle.
+  for (Crossing const &crossing : crossings)
+    ++borderOf(crossing).count;
+  for (Crossing const &crossing : crossings)
+    {
+      Border &border(borderOf(crossing));
+
+      if (border.seen++ == border.count / 2u)
+	{
+	  border.from = crossing.from;
+	  border.to = crossing.to;
+	}
+    }
+  // Pairs of regions in order, so portal lists don't depend on the tiles' order.
+  for (unsigned int a(0u); a != borders.size(); ++a)
+    {
+      std::sort(borders[a].begin(), borders[a].end(), [](Border const &left, Border const &right)
+		{
+		  return left.region < right.region;
+		});
+      for (Border const &border : borders[a])
+	{
+	  unsigned int const b(border.region);
+	  double const cost(std::sqrt((centers[a] - Vect<2u, double>(border.from)).length2())
+			    + 1.0 + std::sqrt((Vect<2u, double>(border.to) - centers[b]).length2()));
+
+	  portals[a].push_back(Portal{b, border.from, border.to, cost});
+	  portals[b].push_back(Portal{a, border.to, border.from, cost});
+	}
+    }
+}
+
+std::vector<RoomGraph::Portal> const &RoomGraph::getPortals(unsigned int region) const
+{
+  return portals[region];
+}
+
+int RoomGraph::searchNextPortal(unsigned int from, unsigned int to)
+{
+  // Straight distance between centers never exceeds a portal's cost, the heuristic is consistent.
+  auto const heuristic([this, to](unsigned int region)
+		       {
+			 return std::sqrt((centers[to] - centers[region]).length2());
+		       });
+  std::priority_queue<std::pair<double, unsigned int>, std::vector<std::pair<double, unsigned int>>,
+		      std::greater<std::pair<double, unsigned int>>> open;
+
+  if (!++stamp)
+    {
+      stamps.assign(stamps.size(), 0u);
+      stamp = 1u;
+    }
+  stamps[from] = stamp;
+  costs[from] = 0.0;
+  firstPortals[from] = -1;
+  open.emplace(heuristic(from), from);
+  while (!open.empty())
+    {
+      auto const current(open.top());
+      unsigned int const region(current.second);
+
+      open.pop();
+      if (region == to)
+	return firstPortals[to];
+      if (current.first != costs[region] + heuristic(region))
+	continue ;
+      for (unsigned int i(0u); i != portals[region].size(); ++i)
+	{
+	  Portal const &portal(portals[region][i]);
+	  double const cost(costs[region] + portal.cost);
+
+	  if (stamps[portal.region] != stamp || cost < costs[portal.region])
+	    {
+	      stamps[portal.region] = stamp;
+	      costs[portal.region] = cost;
+	      firstPortals[portal.region] = region == from ? (int)i : firstPortals[region];
+	      open.emplace(cost + heuristic(portal.region), portal.region);
+	    }
+	}
+    }
+  return -1;
+}
+
+int RoomGraph::planNextPortal(unsigned int from, unsigned int to)
+{
+  unsigned long long const key((unsigned long long)from << 32ull | to);
+  auto const cached(nextPortal.find(key));
+
+  if (cached != nextPortal.end())
+    return cached->second;
+  if (nextPortal.size() == CACHED_PAIRS)
+    nextPortal.clear();
+
+  int const portal(searchNextPortal(from, to));
+
+  nextPortal.emplace(key, portal);
+  return portal;
+}
+
+Vect<2u, unsigned int> RoomGraph::nextStep(Terrain const &terrain, Vect<2u, unsigned int> from, Vect<2u, unsigned int> to)
+{
+  unsigned int const fromRegion(getRegion(from));
+  unsigned int const toRegion(getRegion(to));
+
+  if (fromRegion == NO_REGION || toRegion == NO_REGION)
+    return from;
+  if (fromRegion == toRegion)
+    return localStep(terrain, fromRegion, from, to);
+
+  int const portal(planNextPortal(fromRegion, toRegion));
+
+  if (portal < 0)
+    return from;
+  if (from.equals(portals[fromRegion][portal].from))
+    return portals[fromRegion][portal].to;
+  return localStep(terrain, fromRegion, from, portals[fromRegion][portal].from);
+}
+
+Vect<2u, unsigned int> RoomGraph::localStep(Terrain const &terrain, unsigned int region,
+					    Vect<2u, unsigned int> from, Vect<2u, unsigned int> to) const
+{
+  constexpr int const MARGIN{16};
+
+  if (from.equals(to))
+    return from;
+
+  Vect<2u, int> const origin(std::min((int)from[0], (int)to[0]) - MARGIN, std::min((int)from[1], (int)to[1]) - MARGIN);
+  Vect<2u, int> const size(std::abs((int)from[0] - (int)to[0]) + 2 * MARGIN + 1,
+			   std::abs((int)from[1] - (int)to[1]) + 2 * MARGIN + 1);
+  auto const indexOf([origin, size](Vect<2u, int> tile)
+		     {
+		       return (unsigned int)(tile[0] - origin[0] + (tile[1] - origin[1]) * size[0]);
+		     });
+  auto const inWindow([origin, size](Vect<2u, int> tile)
+		      {
+			return tile[0] >= origin[0] && tile[1] >= origin[1]
+			  && tile[0] < origin[0] + size[0] && tile[1] < origin[1] + size[1];
+		      });
+  auto const isOpen([this, &terrain, region, inWindow](Vect<2u, int> tile)
+		    {
+		      return inWindow(tile) && !terrain.isSolid({(unsigned int)tile[0], (unsigned int)tile[1]})
+			&& getRegion({(unsigned int)tile[0], (unsigned int)tile[1]}) == region;
+		    });
+  auto const heuristic([to](Vect<2u, int> tile)
+		       {
+			 double const dx(std::abs(tile[0] - (int)to[0]));
+			 double const dy(std::abs(tile[1] - (int)to[1]));
+
+			 return std::max(dx, dy) + (std::sqrt(2.0) - 1.0) * std::min(dx, dy);
+		       });
+  std::vector<double> costs((unsigned int)(size[0] * size[1]), std::numeric_limits<double>::infinity());
+  std::vector<unsigned int> parents((unsigned int)(size[0] * size[1]), ~0u);
+  std::priority_queue<std::pair<double, unsigned int>, std::vector<std::pair<double, unsigned int>>,
+		      std::greater<std::pair<double, unsigned int>>> open;
+  Vect<2u, int> const start(from);
+  unsigned int const goal(indexOf(Vect<2u, int>(to)));
+
+  costs[indexOf(start)] = 0.0;
+  open.emplace(heuristic(start), indexOf(start));
+  for (unsigned int expanded(0u); !open.empty() && expanded != LOCAL_SEARCH_LIMIT; ++expanded)
+    {
+      unsigned int const index(open.top().second);
+
+      open.pop();
+      if (index == goal)
+	{
+	  unsigned int step(goal);
+
+	  while (parents[step] != indexOf(start))
+	    step = parents[step];
+	  return {(unsigned int)(origin[0] + (int)(step % (unsigned int)size[0])),
+	      (unsigned int)(origin[1] + (int)(step / (unsigned int)size[0]))};
+	}
+
+      Vect<2u, int> const tile(origin[0] + (int)(index % (unsigned int)size[0]), origin[1] + (int)(index / (unsigned int)size[0]));
+
+      for (int y(-1); y <= 1; ++y)
+	for (int x(-1); x <= 1; ++x)
+	  {
+	    Vect<2u, int> const next(tile[0] + x, tile[1] + y);
+
+	    if ((!x && !y) || !isOpen(next)
+		|| (x && y && (!isOpen({tile[0] + x, tile[1]}) || !isOpen({tile[0], tile[1] + y}))))
+	      continue ;
+
+	    double const cost(costs[index] + (x && y ? std::sqrt(2.0) : 1.0));
+
+	    if (cost < costs[indexOf(next)])
+	      {
+		costs[indexOf(next)] = cost;
+		parents[indexOf(next)] = index;
+		open.emplace(cost + heuristic(next), indexOf(next));
+	      }
+	  }
+    }
+  return from;
+}
@@ -1,6 +1,39 @@
 #include "Spell.hpp"
 #include "Logic.hpp"
 
+/**
+ * Area hit pushing enemies away from its center (former EXPLOSION projectile).
+ */
+struct BlastHit
+{
+  Vect<2u, double> center;
+
+  constexpr void operator()(Controllable &controllable) const
+  {
+    controllable.knockback((controllable.pos - center).normalized() * 0.2, 5);
+    controllable.takeDamage(40);
+  }
+};
+
+/**
+ * Area hit pushing enemies along a direction (former HIT1 projectile).
+ */
+struct PushHit
+{
+  Vect<2u, double> push;
+
+  constexpr void operator()(Controllable &controllable) const
+  {
+    controllable.knockback(push, 10);
+    controllable.takeDamage(35);
+  }
+};
+
+static void blast(Logic &logic, Vect<2u, double> center, double radius)
+{
+  logic.areaEffect(Physics::Circle{center, radius}, center, "explosion", BlastHit{center});
+}
+
 void Spell::update(Logic &logic, Player &player)
 {
   if (!timeLeft && active)
@@ -37,7 +70,7 @@ SpellList::SpellList()
   };
   map[SpellType::FIRE_ULTI] = [](Logic &logic, Player &player, unsigned int time) {
     if (time >= 40 && !(time % 10))
-      logic.spawnProjectile(player.getPos() + player.getDir().normalized() * (time - 30) / 10.0, {0.0, 0.0}, ProjectileType::EXPLOSION, 1.0, 2);
+      blast(logic, player.getPos() + player.getDir().normalized() * (time - 30) / 10.0, 1.0);
   };
 
   map[SpellType::FIRE_BALL] = [](Logic &logic, Player &player, unsigned int time) {
@@ -57,7 +90,7 @@ SpellList::SpellList()
     if (!time)
       player.dash(3.0, 30);
     if (time == 35)
-      logic.spawnProjectile(player.getPos(), {0.0, 0.0}, ProjectileType::EXPLOSION, 2.0, 2);
+      blast(logic, player.getPos(), 2.0);
   };
   map[SpellType::HIT1] = [](Logic &logic, Player &player, unsigned int time) {
     if (time == 50)
@@ -86,7 +119,7 @@ SpellList::SpellList()
     if (time == 239)
       player.radius = 0.5;
     if (!(time % 10))
-      logic.spawnProjectile(player.getPos(), {0.0, 0.0}, ProjectileType::EXPLOSION, player.radius, 2);
+      blast(logic, player.getPos(), player.radius);
   };
   map[SpellType::SPIN] = [](Logic &logic, Player &player, unsigned int time) {
     player.invulnerable = 1;
@@ -103,12 +136,17 @@ SpellList::SpellList()
     if (time == 239)
       player.radius = 0.5;
     if (!(time % 20))
-      logic.spawnProjectile(player.getPos(), {0.0, 0.0}, ProjectileType::EXPLOSION, player.radius * 1.2, 2);
+      blast(logic, player.getPos(), player.radius * 1.2);
   };
   map[SpellType::CHOOCHOO] = [](Logic &logic, Player &player, unsigned int time) {
     player.invulnerable = 1;
     if (time % 50)
-      logic.spawnProjectile(player.getPos() + player.getDir().normalized() * 0.5, player.getDir().normalized() * 0.2, ProjectileType::HIT1, 1.5, 2);
+      {
+	Vect<2u, double> const push(player.getDir().normalized() * 0.2);
+	Vect<2u, double> const center(player.getPos() + player.getDir().normalized() * 0.5 + push);
+
+	logic.areaEffect(Physics::Circle{center, 1.5}, center, "blu", PushHit{push});
+      }
     player.speed += player.getDir().normalized() * 0.005;
   };
   
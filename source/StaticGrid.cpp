@@ -0,0 +1,31 @@
+#include <algorithm>
+#include "StaticGrid.hpp"
+
+StaticGrid::StaticGrid(double cellSize)
+  : cellSize(cellSize)
+  , maxRadius(0.0)
+  , cells()
+{
+}
+
+void StaticGrid::clear()
+{
+  for (auto &cell : cells)
+    cell.second.clear();
+  maxRadius = 0.0;
+}
+
+void StaticGrid::eraseEmptyCells()
+{
+  for (auto cell(cells.begin()); cell != cells.end();)
+    if (cell->second.empty())
+      cell = cells.erase(cell);
+    else
+      ++cell;
+}
+
+void StaticGrid::insert(Vect<2u, double> pos, double radius, unsigned int item)
+{
+  maxRadius = std::max(maxRadius, radius);
+  cells[key(cellOf(pos[0]), cellOf(pos[1]))].push_back(item);
+}
@@ -0,0 +1,178 @@
+#include <array>
+#include <algorithm>
+#include "TerrainMesher.hpp"
+#include "Terrain.hpp"
+
+constexpr float const TerrainMesher::WALL_HEIGHT;
+
+std::size_t TerrainMesher::Mesh::getTriangleCount() const
+{
+  return indices.size() / 3u;
+}
+
+void TerrainMesher::addSide(Mesh &mesh, Vect<3u, float> start, Vect<3u, float> right, float length)
+{
+  Vect<3u, float> const up{0.0f, WALL_HEIGHT, 0.0f};
+  std::uint32_t const offset((std::uint32_t)mesh.vertices.size());
+
+  for (Vect<2u, float> const &coef : {Vect<2u, float>(0.0f, 0.0f), Vect<2u, float>(1.0f, 0.0f),
+	Vect<2u, float>(0.0f, 1.0f), Vect<2u, float>(1.0f, 1.0f)})
+    {
+      Vect<3u, float> const pos(start + right * (coef[0] * length) + up * coef[1]);
+
+      mesh.vertices.push_back(Vertex{{pos[0], pos[1], pos[2]}, {-right[2], 0.0f, right[0]},
+	    {coef[0] * length, coef[1] * WALL_HEIGHT}});
+    }
+  mesh.indices.insert(mesh.indices.end(), {offset, offset + 1u, offset + 3u, offset, offset + 3u, offset + 2u});
+}
+
+void TerrainMesher::addFlat(Mesh &mesh, Vect<2u, float> begin, Vect<2u, float> end, float height)
+{
+  Vect<2u, float> const extent(end - begin);
+  std::uint32_t const offset((std::uint32_t)mesh.vertices.size());
+
+  for (Vect<2u, float> const &coef : {Vect<2u, float>(0.0f, 0.0f), Vect<2u, float>(1.0f, 0.0f),
+	Vect<2u, float>(0.0f, 1.0f), Vect<2u, float>(1.0f, 1.0f)})
+    mesh.vertices.push_back(Vertex{{begin[0] + coef[0] * extent[0], height, begin[1] + coef[1] * extent[1]}, {0.0f, 1.0f, 0.0f},
+	  {coef[0] * extent[0], coef[1] * extent[1]}});
+  mesh.indices.insert(mesh.indices.end(), {offset, offset + 3u, offset + 1u, offset, offset + 2u, offset + 3u});
+}
+
+template<class KIND, class ADD_RECT>
+void TerrainMesher::greedyRects(Vect<2u, unsigned int> size, KIND &&kind, ADD_RECT &&addRect)
+{
+  std::array<std::uint64_t, Terrain::CHUNK_SIZE> covered{};
+
+  for (unsigned int y(0u); y != size[1]; ++y)
+    for (unsigned int x(0u); x != size[0]; ++x)
+      {
+	unsigned int const current(kind(Vect<2u, unsigned int>{x, y}));
+
+	if (!current || ((covered[y] >> x) & 1u))
+	  continue ;
+
+	Vect<2u, unsigned int> end(x + 1u, y + 1u);
+
+	while (end[0] != size[0] && !((covered[y] >> end[0]) & 1u) && kind(Vect<2u, unsigned int>{end[0], y}) == current)
+	  ++end[0];
+
+	std::uint64_t const mask(Terrain::CHUNK_SIZE == end[0] - x ? ~std::uint64_t(0u) : ((std::uint64_t(1u) << (end[0] - x)) - 1u) << x);
+	auto const rowMatches([&](unsigned int row)
+			      {
+				if (covered[row] & mask)
+				  return false;
+				for (unsigned int i(x); i != end[0]; ++i)
+				  if (kind(Vect<2u, unsigned int>{i, row}) != current)
+				    return false;
+				return true;
+			      });
+
+	while (end[1] != size[1] && rowMatches(end[1]))
+	  ++end[1];
+	for (unsigned int row(y); row != end[1]; ++row)
+	  covered[row] |= mask;
+	addRect(Vect<2u, unsigned int>{x, y}, end);
+      }
+}
+
+TerrainMesher::ChunkMesh TerrainMesher::meshChunk(Terrain const &terrain, Vect<2u, unsigned int> chunk)
+{
+  ChunkMesh result;
+  Vect<2u, unsigned int> const corner(chunk * Terrain::CHUNK_SIZE);
+  Vect<2u, unsigned int> const size(std::min(Terrain::CHUNK_SIZE, terrain.getSize()[0] - corner[0]),
+				    std::min(Terrain::CHUNK_SIZE, terrain.getSize()[1] - corner[1]));
+  // Neighbours out of the terrain wrap to huge coordinates, which are solid.
+  auto const isSolid([&terrain, corner](int x, int y)
+		     {
+		       return terrain.isSolid({corner[0] + (unsigned int)x, corner[1] + (unsigned int)y});
+		     });
+
+  greedyRects(size, [&terrain, corner](Vect<2u, unsigned int> tile) -> unsigned int
+	      {
+		Terrain::Tile const floor(terrain.getTile(corner + tile));
+
+		return floor.isSolid ? 0u : floor.roomId + 1u;
+	      }, [&result](Vect<2u, unsigned int> begin, Vect<2u, unsigned int> end)
+	      {
+		addFlat(result.floors, Vect<2u, float>(begin), Vect<2u, float>(end), 0.0f);
+	      });
+  greedyRects(size, [&isSolid](Vect<2u, unsigned int> tile) -> unsigned int
+	      {
+		return isSolid((int)tile[0], (int)tile[1]);
+	      }, [&result](Vect<2u, unsigned int> begin, Vect<2u, unsigned int> end)
+	      {
+		addFlat(result.walls, Vect<2u, float>(begin), Vect<2u, float>(end), WALL_HEIGHT);
+	      });
+
+  // Sides facing -x and +x run along z, sides facing -z and +z along x.
+  for (unsigned int axis(0u); axis != 2u; ++axis)
+    for (int side(-1); side <= 1; side += 2)
+      for (unsigned int line(0u); line != size[axis]; ++line)
+	{
+	  unsigned int const runAxis(1u - axis);
+	  auto const exposed([&](unsigned int i)
+			     {
+			       Vect<2u, int> tile(0, 0);
+
+			       tile[axis] = (int)line;
+			       tile[runAxis] = (int)i;
+			       if (!isSolid(tile[0], tile[1]))
+				 return false;
+			       tile[axis] += side;
+			       return !isSolid(tile[0], tile[1]);
+			     });
+
+	  for (unsigned int begin(0u); begin != size[runAxis]; )
+	    {
+	      if (!exposed(begin))
+		{
+		  ++begin;
+		  continue ;
+		}
+
+	      unsigned int end(begin + 1u);
+
+	      while (end != size[runAxis] && exposed(end))
+		++end;
+
+	      // Faces wind around the tile, as start + right * [0, length] seen from outside.
+	      Vect<2u, float> start(0.0f, 0.0f);
+	      Vect<2u, float> right(0.0f, 0.0f);
+	      bool const forward(axis == 0u ? side < 0 : side > 0);
+
+	      start[axis] = (float)line + (side > 0 ? 1.0f : 0.0f);
+	      start[runAxis] = (float)(forward ? begin : end);
+	      right[runAxis] = forward ? 1.0f : -1.0f;
+	      addSide(result.walls, Vect<3u, float>{start[0], 0.0f, start[1]}, Vect<3u, float>{right[0], 0.0f, right[1]},
+		      (float)(end - begin));
+	      begin = end;
+	    }
+	}
+  return result;
+}
+
+std::vector<TerrainMesher::ChunkMesh> TerrainMesher::meshTerrain(Terrain const &terrain)
+{
+  std::vector<ChunkMesh> result;
+
+  result.reserve(terrain.getChunkCount()[0] * terrain.getChunkCount()[1]);
+  for (Vect<2u, unsigned int> chunk(0u, 0u); chunk[1] != terrain.getChunkCount()[1]; ++chunk[1])
+    for (chunk[0] = 0u; chunk[0] != terrain.getChunkCount()[0]; ++chunk[0])
+      result.push_back(meshChunk(terrain, chunk));
+  return result;
+}
+
+TerrainMesher::Report TerrainMesher::report(Terrain const &terrain)
+{
+  Report result{0u, 0u, 0u};
+
+  for (Vect<2u, unsigned int> tile(0u, 0u); tile[1] != terrain.getSize()[1]; ++tile[1])
+    for (tile[0] = 0u; tile[0] != terrain.getSize()[0]; ++tile[0])
+      result.tileTriangles += terrain.isSolid(tile) ? 10u : 2u;
+  for (ChunkMesh const &mesh : meshTerrain(terrain))
+    {
+      result.wallTriangles += mesh.walls.getTriangleCount();
+      result.floorTriangles += mesh.floors.getTriangleCount();
+    }
+  return result;
+}
@@ -1,92 +1,517 @@
+#include <cmath>
 #include <random>
 #include <algorithm>
+#include <stdexcept>
 #include "Terrain.hpp"
+#include "WorkerPool.hpp"
 
-Terrain::Terrain()
-  : tiles{}
+constexpr unsigned int const Terrain::CHUNK_SHIFT;
+constexpr unsigned int const Terrain::CHUNK_SIZE;
+constexpr unsigned int const Terrain::MAX_SIZE;
+constexpr unsigned int const Terrain::GENERATOR_VERSION;
+constexpr unsigned int const Terrain::DEFAULT_ROOM_COUNT;
+constexpr unsigned int const Terrain::MAX_ROOM_COUNT;
+constexpr unsigned int const Terrain::PARALLEL_TILES;
+constexpr unsigned int const Terrain::CORRIDOR_WIDTH;
+constexpr unsigned int const Terrain::LANE_MARGIN;
+
+Terrain::Chunk::Chunk()
+  : solid{}
+  , roomIds{}
+{
+  solid.fill(~std::uint64_t(0u));
+}
+
+Terrain::Terrain(Vect<2u, unsigned int> size)
+  : size{0u, 0u}
+  , chunkCount{0u, 0u}
+  , chunks()
+  , chunkRooms()
+  , rooms()
+  , freeRooms()
+  , origin{0l, 0l}
   , seed(0u)
-{}
+  , distanceField()
+  , roomGraph()
+{
+  resize(size);
+}
+
+void Terrain::resize(Vect<2u, unsigned int> size)
+{
+  if (size[0] > MAX_SIZE || size[1] > MAX_SIZE)
+    throw std::invalid_argument("Terrain::resize: terrain too big");
+  this->size = size;
+  chunkCount = {(size[0] + CHUNK_SIZE - 1u) >> CHUNK_SHIFT, (size[1] + CHUNK_SIZE - 1u) >> CHUNK_SHIFT};
+  chunks.clear();
+  chunks.resize(chunkCount[0] * chunkCount[1]);
+  chunkRooms.assign(chunks.size(), 0u);
+}
 
 Vect<2u, unsigned int> Terrain::getSize() const
 {
-  return {100u, 100u};
+  return size;
+}
+
+Vect<2u, unsigned int> Terrain::getChunkCount() const
+{
+  return chunkCount;
+}
+
+Vect<2u, long> Terrain::getOrigin() const
+{
+  return origin;
+}
+
+unsigned int Terrain::getSeed() const
+{
+  return seed;
+}
+
+unsigned int Terrain::getChunkRoom(Vect<2u, unsigned int> chunk) const
+{
+  return chunkRooms[chunk[0] + chunk[1] * chunkCount[0]];
+}
+
+bool Terrain::hasChunk(Vect<2u, unsigned int> chunk) const
+{
+  return !!chunks[chunk[0] + chunk[1] * chunkCount[0]];
+}
+
+void Terrain::bakeDistanceField(WorkerPool *pool)
+{
+  distanceField.bake(*this, pool);
+}
+
+DistanceField const &Terrain::getDistanceField() const
+{
+  return distanceField;
 }
 
 Terrain::Room &Terrain::getRoom(Vect<2u, unsigned int> pos)
 {
-  return rooms[getTile(pos).roomId];
+  return rooms[getRoomId(pos)];
+}
+
+std::vector<Terrain::Room> &Terrain::getRooms()
+{
+  return rooms;
+}
+
+std::vector<Terrain::Room> const &Terrain::getRooms() const
+{
+  return rooms;
+}
+
+RoomGraph &Terrain::getRoomGraph()
+{
+  return roomGraph;
+}
+
+Terrain::Tile Terrain::getTile(Vect<2u, unsigned int> pos) const
+{
+  return {isSolid(pos), getRoomId(pos)};
+}
+
+void Terrain::setTile(Vect<2u, unsigned int> pos, Tile tile)
+{
+  if (pos[0] >= size[0] || pos[1] >= size[1])
+    return ;
+
+  auto &chunk(chunks[(pos[0] >> CHUNK_SHIFT) + (pos[1] >> CHUNK_SHIFT) * chunkCount[0]]);
+  std::uint64_t const bit(std::uint64_t(1u) << (pos[0] & (CHUNK_SIZE - 1u)));
+  std::uint64_t &row((chunk ? chunk : chunk = std::make_unique<Chunk>())->solid[pos[1] & (CHUNK_SIZE - 1u)]);
+
+  row = tile.isSolid ? row | bit : row & ~bit;
+  chunk->roomIds[(pos[0] & (CHUNK_SIZE - 1u)) + (pos[1] & (CHUNK_SIZE - 1u)) * CHUNK_SIZE] = (std::uint16_t)tile.roomId;
+}
+
+void Terrain::RayBatch::clear()
+{
+  startX.clear();
+  startY.clear();
+  endX.clear();
+  endY.clear();
+}
+
+void Terrain::RayBatch::add(Vect<2u, double> start, Vect<2u, double> end)
+{
+  startX.push_back(start[0]);
+  startY.push_back(start[1]);
+  endX.push_back(end[0]);
+  endY.push_back(end[1]);
+}
+
+std::size_t Terrain::RayBatch::size() const
+{
+  return startX.size();
+}
+
+void Terrain::raycast(RayBatch &batch) const
+{
+  std::size_t const count(batch.size());
+  // Per ray: length, then the ray parameter needed to cross one tile on each axis.
+  std::vector<double> length(count);
+  std::vector<double> deltaX(count);
+  std::vector<double> deltaY(count);
+
+  batch.distance.resize(count);
+  batch.tileX.resize(count);
+  batch.tileY.resize(count);
+  batch.hit.resize(count);
+  for (std::size_t i(0u); i != count; ++i)
+    {
+      double const dx(batch.endX[i] - batch.startX[i]);
+      double const dy(batch.endY[i] - batch.startY[i]);
+
+      length[i] = std::sqrt(dx * dx + dy * dy);
+      deltaX[i] = dx != 0.0 ? length[i] / std::abs(dx) : HUGE_VAL;
+      deltaY[i] = dy != 0.0 ? length[i] / std::abs(dy) : HUGE_VAL;
+    }
+  for (std::size_t i(0u); i != count; ++i)
+    {
+      int const stepX(batch.endX[i] > batch.startX[i] ? 1 : -1);
+      int const stepY(batch.endY[i] > batch.startY[i] ? 1 : -1);
+      Vect<2u, int> tile((int)std::floor(batch.startX[i]), (int)std::floor(batch.startY[i]));
+      double nextX(deltaX[i] * (stepX > 0 ? tile[0] + 1.0 - batch.startX[i] : batch.startX[i] - tile[0]));
+      double nextY(deltaY[i] * (stepY > 0 ? tile[1] + 1.0 - batch.startY[i] : batch.startY[i] - tile[1]));
+      double distance(0.0);
+      bool hit(isSolid({(unsigned int)tile[0], (unsigned int)tile[1]}));
+
+      while (!hit && distance < length[i])
+	{
+	  if (nextX < nextY)
+	    {
+	      distance = nextX;
+	      nextX += deltaX[i];
+	      tile[0] += stepX;
+	    }
+	  else
+	    {
+	      distance = nextY;
+	      nextY += deltaY[i];
+	      tile[1] += stepY;
+	    }
+	  hit = distance < length[i] && isSolid({(unsigned int)tile[0], (unsigned int)tile[1]});
+	}
+      batch.distance[i] = std::min(distance, length[i]);
+      batch.tileX[i] = (unsigned int)tile[0];
+      batch.tileY[i] = (unsigned int)tile[1];
+      batch.hit[i] = hit;
+    }
+}
+
+bool Terrain::lineOfSight(Vect<2u, double> start, Vect<2u, double> end) const
+{
+  RayBatch batch;
+
+  batch.add(start, end);
+  raycast(batch);
+  return !batch.hit[0];
+}
+
+Terrain::Stamp Terrain::clip(long beginX, long beginY, long endX, long endY, unsigned int roomId) const
+{
+  auto const clamp([](long value, unsigned int max)
+		   {
+		     return (unsigned int)std::min(std::max(value, 0l), (long)max);
+		   });
+  Stamp stamp{{clamp(beginX, size[0]), clamp(beginY, size[1])}, {clamp(endX, size[0]), clamp(endY, size[1])}, roomId};
+
+  stamp.end = {std::max(stamp.begin[0], stamp.end[0]), std::max(stamp.begin[1], stamp.end[1])};
+  return stamp;
+}
+
+bool Terrain::isSolid(Stamp const &stamp) const
+{
+  bool solid(true);
+
+  forEachSpan(stamp, 0u, size[1], [this, &solid](unsigned int chunk, unsigned int row, unsigned int first, unsigned int last)
+	      {
+		solid = solid && (!chunks[chunk] || (chunks[chunk]->solid[row] & rowMask(first, last)) == rowMask(first, last));
+	      });
+  return solid;
 }
 
-Terrain::Tile const &Terrain::getTile(Vect<2u, unsigned int> pos) const
+void Terrain::carve(Stamp const &stamp)
 {
-  if (pos[0] >= getSize()[0] || pos[1] >= getSize()[1])
-    return tiles[0][0];
-  return tiles[pos[0]][pos[1]];
+  forEachSpan(stamp, 0u, size[1], [this](unsigned int chunk, unsigned int row, unsigned int first, unsigned int last)
+	      {
+		if (!chunks[chunk])
+		  chunks[chunk] = std::make_unique<Chunk>();
+		chunks[chunk]->solid[row] &= ~rowMask(first, last);
+	      });
 }
 
-Terrain::Tile &Terrain::getTile(Vect<2u, unsigned int> pos)
+void Terrain::paintRoomIds(Stamp const &stamp, unsigned int rowBegin, unsigned int rowEnd)
 {
-  if (pos[0] >= getSize()[0] || pos[1] >= getSize()[1])
-    return tiles[0][0];
-  return tiles[pos[0]][pos[1]];
+  forEachSpan(stamp, rowBegin, rowEnd, [this, &stamp](unsigned int chunk, unsigned int row, unsigned int first, unsigned int last)
+	      {
+		std::uint16_t *const line(chunks[chunk]->roomIds.data() + row * CHUNK_SIZE);
+
+		std::fill(line + first, line + last, (std::uint16_t)stamp.roomId);
+	      });
 }
 
-void Terrain::generateLevel(unsigned int seed)
+void Terrain::generateLevel(unsigned int seed, unsigned int roomCount, WorkerPool *pool)
 {
+  if (roomCount < 2u || roomCount > MAX_ROOM_COUNT)
+    throw std::invalid_argument("Terrain::generateLevel: room count out of range");
   this->seed = seed;
-  for (Vect<2u, unsigned int> i(0u, 0u); i[1] != getSize()[1]; ++i[1])
-    for (i[0]  = 0u; i[0] != getSize()[0]; ++i[0])
-      getTile(i) = {true, 0u};
+  resize(size);
+  rooms.clear();
+  freeRooms.clear();
+  origin = {0l, 0l};
 
   std::minstd_rand engine(seed);
   std::uniform_int_distribution<> rangeX(10, getSize()[0] - 10);
   std::uniform_int_distribution<> rangeY(10, getSize()[1] - 10);
   std::uniform_int_distribution<> range10(5, 10);
   std::uniform_int_distribution<> range5(1, 5);
-  // std::vector<Vect<2u, unsigned int>> rooms;
 
   rooms.emplace_back(Vect<2u, unsigned int>{5u, 5u});
-  for (unsigned int i(1); i < 30; ++i)
+  for (unsigned int i(1); i < roomCount - 1u; ++i)
     rooms.emplace_back(Vect<2u, unsigned int>{static_cast<unsigned int>(rangeX(engine)), static_cast<unsigned int>(rangeY(engine))}, i, false);
-  rooms.emplace_back(getSize() - Vect<2u, unsigned int>{5u, 5u}, 30u, false);
-  std::vector<Vect<2u, unsigned int>> startNodes{};
+  rooms.emplace_back(getSize() - Vect<2u, unsigned int>{5u, 5u}, roomCount - 1u, false);
 
-  startNodes.emplace_back(getSize()[0] / 2u, getSize()[1] / 2u);
+  // Every corridor starts from the center of the map.
+  Vect<2u, unsigned int> const center(getSize()[0] / 2u, getSize()[1] / 2u);
+  std::vector<Stamp> stamps;
+
+  // Solidity doesn't depend on the order tiles are carved in, it is done right away.
+  // Room ids do, they are painted afterward in the same order.
   for (auto &&room : rooms)
     {
-      bool genConnection(true);
-
       Vect<2u, unsigned int> size(static_cast<unsigned int>((range10(engine) + range10(engine)) / 2u),
 				  static_cast<unsigned int>((range10(engine) + range10(engine)) / 2u));
       Vect<2u, unsigned int> relative(static_cast<unsigned int>(range5(engine)), static_cast<unsigned int>(range5(engine)));
       if (!room.id)
 	size = {10, 10};
 
-      for (Vect<2u, unsigned int> i(0u, 0u); i[1] != size[1]; ++i[1])
-	for (i[0] = 0u; i[0] != size[0]; ++i[0])
-	  {
-	    genConnection = genConnection && getTile(i + room.pos - relative).isSolid;
-	    getTile(i + room.pos - relative) = {false, room.id};
-	  }
+      Vect<2u, long> const corner((long)room.pos[0] - (long)relative[0], (long)room.pos[1] - (long)relative[1]);
+
+      stamps.push_back(clip(corner[0], corner[1], corner[0] + (long)size[0], corner[1] + (long)size[1], room.id));
+
+      bool const genConnection(isSolid(stamps.back()));
+
+      carve(stamps.back());
       if (genConnection)
       	{
-	  Vect<2u, unsigned int> start(*std::min_element(startNodes.begin(), startNodes.end(),
-							 [room](auto const &a, auto const &b)
-							 {
-							   return (room.pos - a).length2() < (room.pos - b).length2();
-							 }));
+	  Vect<2u, unsigned int> start(center);
 	  unsigned int firstDir(std::uniform_int_distribution<>(0, 1)(engine));
 	  unsigned int width(std::uniform_int_distribution<>(2, 3)(engine));
 
 	  for (unsigned int k : {firstDir, 1 - firstDir})
 	    {
-	      while (start[k] != room.pos[k])
-	      	{
-		  for (Vect<2u, unsigned int> l(0u, 0u); l[1 - k] != width; ++l[1 - k])
-		    getTile(start + l) = {false, 0u};
-		  start[k] += (start[k] < room.pos[k]) - (start[k] > room.pos[k]);
-		}
+	      unsigned int const target((unsigned int)room.pos[k]);
+
+	      if (start[k] == target)
+		continue ;
+
+	      // From start to target, target excluded, width tiles wide.
+	      long begin[2];
+	      long end[2];
+
+	      begin[k] = start[k] < target ? (long)start[k] : (long)target + 1l;
+	      end[k] = start[k] < target ? (long)target : (long)start[k] + 1l;
+	      begin[1 - k] = (long)start[1 - k];
+	      end[1 - k] = (long)start[1 - k] + (long)width;
+	      stamps.push_back(clip(begin[0], begin[1], end[0], end[1], 0u));
+	      carve(stamps.back());
+	      start[k] = target;
 	    }
 	}
     }
+
+  auto const paint([this, &stamps](unsigned int rowBegin, unsigned int rowEnd)
+		   {
+		     for (Stamp const &stamp : stamps)
+		       paintRoomIds(stamp, rowBegin, rowEnd);
+		   });
+
+  if (!pool || size[0] * size[1] < PARALLEL_TILES)
+    paint(0u, size[1]);
+  else
+    // Workers own whole rows of chunks, and each keeps the stamps' order.
+    pool->run([this, pool, &paint](unsigned int worker)
+	      {
+		paint(chunkCount[1] * worker / pool->getSize() * CHUNK_SIZE,
+		      std::min(chunkCount[1] * (worker + 1u) / pool->getSize() * CHUNK_SIZE, size[1]));
+	      });
+  bakeDistanceField(pool);
+  roomGraph.build(*this);
+}
+
+static std::uint64_t mix(std::uint64_t value)
+{
+  value ^= value >> 33u;
+  value *= 0xFF51AFD7ED558CCDull;
+  value ^= value >> 33u;
+  value *= 0xC4CEB9FE1A85EC53ull;
+  value ^= value >> 33u;
+  return value;
+}
+
+std::uint64_t Terrain::chunkHash(Vect<2u, long> world, unsigned int salt) const
+{
+  return mix(mix(mix(seed | (std::uint64_t)salt << 32u) ^ (std::uint64_t)world[0]) ^ (std::uint64_t)world[1]);
+}
+
+unsigned int Terrain::laneOf(Vect<2u, long> world, unsigned int axis) const
+{
+  return LANE_MARGIN + (unsigned int)(chunkHash(world, 1u + axis) % (CHUNK_SIZE - 2u * LANE_MARGIN - CORRIDOR_WIDTH + 1u));
+}
+
+unsigned int Terrain::allocateRoom(Vect<2u, double> pos)
+{
+  if (freeRooms.empty())
+    {
+      rooms.emplace_back(pos, (unsigned int)rooms.size(), false);
+      return rooms.back().id;
+    }
+
+  unsigned int const id(freeRooms.back());
+
+  freeRooms.pop_back();
+  rooms[id] = Room(pos, id, false);
+  return id;
+}
+
+void Terrain::releaseRoom(unsigned int id)
+{
+  rooms[id] = Room(rooms[id].pos, id, true);
+  freeRooms.push_back(id);
+}
+
+void Terrain::generateChunk(Vect<2u, unsigned int> chunk)
+{
+  unsigned int const index(chunk[0] + chunk[1] * chunkCount[0]);
+  Vect<2u, long> const world(origin + Vect<2u, long>(chunk));
+  Vect<2u, long> const base(Vect<2u, long>(chunk * CHUNK_SIZE));
+  std::minstd_rand engine((std::minstd_rand::result_type)chunkHash(world, 0u));
+  std::uniform_int_distribution<unsigned int> roomSide(6u, 14u);
+  Vect<2u, unsigned int> const roomSize(roomSide(engine), roomSide(engine));
+  Vect<2u, unsigned int> const corner(std::uniform_int_distribution<unsigned int>(LANE_MARGIN, CHUNK_SIZE - LANE_MARGIN - roomSize[0])(engine),
+				      std::uniform_int_distribution<unsigned int>(LANE_MARGIN, CHUNK_SIZE - LANE_MARGIN - roomSize[1])(engine));
+  Vect<2u, unsigned int> const hub(corner + roomSize / 2u);
+  std::vector<Stamp> stamps;
+
+  chunks[index] = std::make_unique<Chunk>();
+  chunkRooms[index] = allocateRoom(Vect<2u, double>(base + Vect<2u, long>(hub)) + Vect<2u, double>{0.5, 0.5});
+  // Both sides of a border draw its lane from the same world chunk, so corridors line up.
+  for (unsigned int axis(0u); axis != 2u; ++axis)
+    for (bool const next : {false, true})
+      {
+	Vect<2u, long> neighbour(world);
+
+	neighbour[axis] -= !next;
+
+	unsigned int const lane(laneOf(neighbour, axis));
+	unsigned int const border(next ? CHUNK_SIZE : 0u);
+	long begin[2];
+	long end[2];
+
+	// From the hub to the lane, then along the lane to the border.
+	begin[axis] = (long)hub[axis];
+	end[axis] = (long)(hub[axis] + CORRIDOR_WIDTH);
+	begin[1 - axis] = (long)std::min(hub[1 - axis], lane);
+	end[1 - axis] = (long)(std::max(hub[1 - axis], lane) + CORRIDOR_WIDTH);
+	stamps.push_back(clip(base[0] + begin[0], base[1] + begin[1], base[0] + end[0], base[1] + end[1], 0u));
+	begin[axis] = (long)std::min(hub[axis], border);
+	end[axis] = (long)std::max(hub[axis] + CORRIDOR_WIDTH, border);
+	begin[1 - axis] = (long)lane;
+	end[1 - axis] = (long)(lane + CORRIDOR_WIDTH);
+	stamps.push_back(clip(base[0] + begin[0], base[1] + begin[1], base[0] + end[0], base[1] + end[1], 0u));
+      }
+  stamps.push_back(clip(base[0] + (long)corner[0], base[1] + (long)corner[1],
+			base[0] + (long)(corner[0] + roomSize[0]), base[1] + (long)(corner[1] + roomSize[1]), chunkRooms[index]));
+  for (Stamp const &stamp : stamps)
+    {
+      carve(stamp);
+      paintRoomIds(stamp, 0u, size[1]);
+    }
+}
+
+void Terrain::startEndless(unsigned int seed, Vect<2u, unsigned int> windowChunks, Vect<2u, long> origin,
+			   WorkerPool *pool)
+{
+  this->seed = seed;
+  resize(windowChunks * CHUNK_SIZE);
+  rooms.clear();
+  freeRooms.clear();
+  this->origin = origin;
+  rooms.emplace_back(Vect<2u, double>{0.0, 0.0});
+  for (Vect<2u, unsigned int> chunk(0u, 0u); chunk[1] != chunkCount[1]; ++chunk[1])
+    for (chunk[0] = 0u; chunk[0] != chunkCount[0]; ++chunk[0])
+      generateChunk(chunk);
+  bakeDistanceField(pool);
+  roomGraph.build(*this);
+}
+
+void Terrain::shiftWindow(Vect<2u, int> delta)
+{
+  std::vector<unsigned char> const stale(moveWindow(delta));
+
+  for (Vect<2u, unsigned int> chunk(0u, 0u); chunk[1] != chunkCount[1]; ++chunk[1])
+    for (chunk[0] = 0u; chunk[0] != chunkCount[0]; ++chunk[0])
+      if (stale[chunk[0] + chunk[1] * chunkCount[0]])
+	distanceField.bakeChunk(*this, chunk);
+  roomGraph.build(*this);
+}
+
+void Terrain::shiftWindow(Terrain &&next)
+{
+  if (next.seed != seed || !next.size.equals(size))
+    throw std::invalid_argument("Terrain::shiftWindow: next window doesn't match");
+  moveWindow(Vect<2u, int>(next.origin - origin));
+  distanceField = std::move(next.distanceField);
+  roomGraph = std::move(next.roomGraph);
+}
+
+std::vector<unsigned char> Terrain::moveWindow(Vect<2u, int> delta)
+{
+  std::vector<std::unique_ptr<Chunk>> moved(chunks.size());
+  std::vector<unsigned int> movedRooms(chunks.size(), 0u);
+  Vect<2u, double> const offset((double)delta[0] * CHUNK_SIZE, (double)delta[1] * CHUNK_SIZE);
+
+  for (Vect<2u, unsigned int> chunk(0u, 0u); chunk[1] != chunkCount[1]; ++chunk[1])
+    for (chunk[0] = 0u; chunk[0] != chunkCount[0]; ++chunk[0])
+      {
+	unsigned int const index(chunk[0] + chunk[1] * chunkCount[0]);
+	long const x((long)chunk[0] - delta[0]);
+	long const y((long)chunk[1] - delta[1]);
+
+	if (x >= 0l && y >= 0l && x < (long)chunkCount[0] && y < (long)chunkCount[1])
+	  {
+	    moved[(unsigned int)x + (unsigned int)y * chunkCount[0]] = std::move(chunks[index]);
+	    movedRooms[(unsigned int)x + (unsigned int)y * chunkCount[0]] = chunkRooms[index];
+	  }
+	else if (chunkRooms[index])
+	  releaseRoom(chunkRooms[index]);
+      }
+  chunks.swap(moved);
+  chunkRooms.swap(movedRooms);
+  origin += Vect<2u, long>(delta);
+  for (Room &room : rooms)
+    room.pos -= offset;
+  distanceField.shift(delta);
+
+  // Samples near a chunk's border depend on its neighbours: those of new chunks changed,
+  // and chunks now on the window's trailing edge lost theirs.
+  std::vector<unsigned char> stale(chunks.size(), 0u);
+
+  for (Vect<2u, unsigned int> chunk(0u, 0u); chunk[1] != chunkCount[1]; ++chunk[1])
+    for (chunk[0] = 0u; chunk[0] != chunkCount[0]; ++chunk[0])
+      {
+	for (unsigned int i(0u); i != 2u; ++i)
+	  if ((delta[i] > 0 && chunk[i] == 0u) || (delta[i] < 0 && chunk[i] == chunkCount[i] - 1u))
+	    stale[chunk[0] + chunk[1] * chunkCount[0]] = 1u;
+	if (chunks[chunk[0] + chunk[1] * chunkCount[0]])
+	  continue ;
+	generateChunk(chunk);
+	for (unsigned int y(chunk[1] ? chunk[1] - 1u : 0u); y != std::min(chunk[1] + 2u, chunkCount[1]); ++y)
+	  for (unsigned int x(chunk[0] ? chunk[0] - 1u : 0u); x != std::min(chunk[0] + 2u, chunkCount[0]); ++x)
+	    stale[x + y * chunkCount[0]] = 1u;
+      }
+  return stale;
 }
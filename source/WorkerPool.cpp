@@ -0,0 +1,85 @@
+#include "WorkerPool.hpp"
+
+WorkerPool::WorkerPool(unsigned int size)
+  : threads()
+  , running()
+  , lock()
+  , wake()
+  , done()
+  , job()
+  , generation(0u)
+  , pending(0u)
+  , stop(false)
+{
+  for (unsigned int worker(1u); worker < size; ++worker)
+    threads.emplace_back([this, worker]()
+			 {
+			   work(worker);
+			 });
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> const lock_guard(lock);
+
+    stop = true;
+  }
+  wake.notify_all();
+  for (std::thread &thread : threads)
+    thread.join();
+}
+
+void WorkerPool::work(unsigned int worker)
+{
+  unsigned int seen(0u);
+
+  while (true)
+    {
+      {
+	std::unique_lock<std::mutex> unique_lock(lock);
+
+	wake.wait(unique_lock, [this, seen]()
+		  {
+		    return stop || generation != seen;
+		  });
+	if (stop)
+	  return ;
+	seen = generation;
+      }
+      job(worker);
+      {
+	std::lock_guard<std::mutex> const lock_guard(lock);
+
+	if (!--pending)
+	  done.notify_one();
+      }
+    }
+}
+
+unsigned int WorkerPool::getSize() const
+{
+  return (unsigned int)threads.size() + 1u;
+}
+
+void WorkerPool::run(std::function<void(unsigned int)> const &job)
+{
+  std::lock_guard<std::mutex> const running_guard(running);
+
+  {
+    std::lock_guard<std::mutex> const lock_guard(lock);
+
+    this->job = job;
+    pending = (unsigned int)threads.size();
+    ++generation;
+  }
+  wake.notify_all();
+  job(0u);
+
+  std::unique_lock<std::mutex> unique_lock(lock);
+
+  done.wait(unique_lock, [this]()
+	    {
+	      return !pending;
+	    });
+}